@@ -23,6 +23,7 @@
 
 #include <ideal_export.h>
 #include <core/ideal_string.h>
+#include <core/ref_count.h>
 
 #include <typeinfo>
 
@@ -219,13 +220,12 @@ public:
 
     void ref()
     {
-        ++m_refs;
+        m_refs.ref();
     }
 
     void deref()
     {
-        --m_refs;
-        if (!m_refs) {
+        if (m_refs.deref()) {
             delete this;
         }
     }
@@ -234,7 +234,7 @@ public:
     virtual bool equals(const Any &any) const = 0;
 
 private:
-    size_t m_refs;
+    RefCount m_refs;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -414,10 +414,47 @@
  * @code
  * object->myComplexSignal.connectMulti(whatever, &Whatever::aMultiSlotExample);
  * @endcode
+ *
+ * @section queuedConnections Queued connections
+ *
+ * Slots connected with connect() are called right away from the thread that emitted the signal.
+ * If a signal is emitted from a different thread, for instance from a Thread or from a File
+ * operation, the receiver would have to protect its state with a Mutex. Instead, the signal can
+ * be connected with connectQueued():
+ *
+ * @code
+ * file->statResult.connectQueued(myObject, &MyObject::statResultSlot);
+ * @endcode
+ *
+ * When statResult is emitted, its arguments are copied and the emitting thread returns
+ * immediately. statResultSlot will be called later from the event loop myObject belongs to, in the
+ * same order the signal was emitted. If myObject is destroyed before that happens, the call is
+ * discarded.
+ *
+ * @section signalProfiling Finding hot signals
+ *
+ * When the library is configured with "./waf configure --signal-profiling", every emission is
+ * accounted for the name and signature given to IDEAL_SIGNAL_INIT. The counters can be read at any
+ * time from the application:
+ *
+ * @code
+ * app.dumpSignalStats();
+ * @endcode
+ *
+ * This mode adds two clock reads to each emission, so it is meant for finding out which signals
+ * are worth optimizing, not for release builds.
+ *
+ * @section mutexProfiling Finding contended mutexes
+ *
+ * In the same way, "./waf configure --mutex-profiling" makes every Mutex account how many times it
+ * was locked, how many of them it had to wait, for how long, and the longest time it was held.
+ * Mutexes are grouped by the place of the source code they were created at:
+ *
+ * @code
+ * app.dumpMutexStats();
+ * @endcode
  */
 
-#include <algorithm>
-
 #include "application.h"
 #include "private/application_p.h"
 #include "timer.h"
@@ -427,13 +464,15 @@
 #include "private/event_dispatcher_p.h"
 #include "event.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace IdealCore {
 
 Application::Private::Private(Application *q)
     : m_prefixSet(false)
-    , m_sleepTime(-1)
-    , m_defaultSleepTime(500)
-    , m_nextTimeout(-1)
+    , m_eventLoop(&m_eventDispatcherPool)
+    , m_eventDispatcherPool(q)
     , q(q)
 {
 }
@@ -442,107 +481,6 @@ Application::Private::~Private()
 {
 }
 
-void Application::Private::processEvents()
-{
-    iint32 timeToSleep;
-    if (m_sleepTime != -1) {
-        checkTimers();
-        timeToSleep = m_sleepTime;
-    } else {
-        ContextMutexLocker cml(m_runningTimerListMutex);
-        if (!m_runningTimerList.empty()) {
-            m_sleepTime = m_runningTimerList.front()->d->m_interval;
-            timeToSleep = m_sleepTime;
-        } else {
-            timeToSleep = m_defaultSleepTime;
-        }
-    }
-    Timer::wait(timeToSleep);
-}
-
-void Application::Private::processDelayedDeletions()
-{
-    List<Object*> markedForDeletion;
-    {
-        ContextMutexLocker cml(m_markedForDeletionMutex);
-        markedForDeletion = m_markedForDeletion;
-        m_markedForDeletion.clear();
-    }
-    List<Object*>::iterator it;
-    for (it = markedForDeletion.begin(); it != markedForDeletion.end(); ++it) {
-        delete *it;
-    }
-}
-
-bool Application::Private::timerSort(const Timer *left, const Timer *right)
-{
-    return left->d->m_remaining < right->d->m_remaining;
-}
-
-void Application::Private::checkTimers()
-{
-    List<Timer*> expiredTimerList;
-    {
-        ContextMutexLocker cml(m_runningTimerListMutex);
-        if (m_runningTimerList.empty()) {
-            return;
-        }
-        Timer *const firstExpiredTimer = m_runningTimerList.front();
-        {
-            // We control here the case in which the timer that was going to expire
-            // (the head of the queue) was removed before actually expiring. With this
-            // check we won't fire an incorrect timer when it had already time remaining.
-            const iint32 msDelta = firstExpiredTimer->d->m_remaining - m_sleepTime;
-            if (msDelta) {
-                std::vector<Timer*>::iterator it;
-                for (it = m_runningTimerList.begin(); it != m_runningTimerList.end(); ++it) {
-                    Timer *const currTimer = *it;
-                    currTimer->d->m_remaining -= m_sleepTime;
-                }
-                m_sleepTime = std::min(msDelta, m_defaultSleepTime);
-                return;
-            }
-        }
-        m_nextTimeout = firstExpiredTimer->d->m_remaining;
-        std::vector<Timer*>::iterator it = m_runningTimerList.begin();
-        while (it != m_runningTimerList.end()) {
-            Timer *const currTimer = *it;
-            if (currTimer->d->m_remaining == firstExpiredTimer->d->m_remaining) {
-                if (currTimer->d->m_timeoutType == Timer::SingleShot) {
-                    currTimer->d->m_state = Timer::Stopped;
-                    it = m_runningTimerList.erase(it);
-                } else {
-                    currTimer->d->m_remaining = currTimer->d->m_interval;
-                    ++it;
-                }
-                expiredTimerList.push_back(currTimer);
-            } else {
-                break;
-            }
-        }
-        if (!m_runningTimerList.empty()) {
-            while (it != m_runningTimerList.end()) {
-                Timer *const currTimer = *it;
-                currTimer->d->m_remaining -= m_nextTimeout;
-                ++it;
-            }
-            std::sort(m_runningTimerList.begin(), m_runningTimerList.end(), PrivateImpl::timerSort);
-            Timer *const nextTimer = m_runningTimerList.front();
-            m_sleepTime = nextTimer->d->m_remaining;
-        } else {
-            m_sleepTime = -1;
-        }
-    }
-    List<Timer*>::iterator it;
-    for (it = expiredTimerList.begin(); it != expiredTimerList.end(); ++it) {
-        Timer *const currTimer = *it;
-        EventDispatcher *eventDispatcher = new EventDispatcher(q);
-        Event *event = new Event(currTimer, Event::Timeout);
-        eventDispatcher->postEvent(event);
-        eventDispatcher->exec();
-    }
-}
-
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 Application::Application(iint32 argc, ichar **argv, const String &name)
@@ -554,6 +492,8 @@ Application::Application(iint32 argc, ichar **argv, const String &name)
     d->m_argv = argv;
     d->m_name = name.empty() ? argv[0] : name;
     static_cast<Object*>(this)->d->m_application = this;
+    static_cast<Object*>(this)->d->m_eventLoop = &d->m_eventLoop;
+    static_cast<Object*>(this)->d->m_childrenEventLoop = &d->m_eventLoop;
 }
 
 Application::~Application()
@@ -574,12 +514,143 @@ Locale Application::locale() const
 iint32 Application::exec()
 {
     IDEAL_FOREVER {
-        d->processEvents();
-        d->processDelayedDeletions();
+        d->m_eventLoop.processEvents();
         d->checkFileWatches();
         d->unloadUnneededDynamicLibraries();
     }
     return 0;
 }
 
+void Application::setDispatcherPoolSize(iint32 size)
+{
+    d->m_eventDispatcherPool.setSize(size);
+}
+
+iint32 Application::dispatcherPoolSize() const
+{
+    return d->m_eventDispatcherPool.size();
+}
+
+void Application::setDispatcherQueueDepth(iint32 depth)
+{
+    d->m_eventDispatcherPool.setQueueDepth(depth);
+}
+
+iint32 Application::dispatcherQueueDepth() const
+{
+    return d->m_eventDispatcherPool.queueDepth();
+}
+
+iint32 Application::pendingEvents() const
+{
+    return d->m_eventDispatcherPool.pendingEvents();
+}
+
+List<Application::DispatcherStats> Application::dispatcherStats() const
+{
+    return d->m_eventDispatcherPool.stats();
+}
+
+List<Application::SignalStats> Application::signalStats() const
+{
+    List<SignalStats> res;
+#ifdef IDEAL_SIGNAL_PROFILING
+    List<SignalProfile*> profiles = SignalProfile::profiles();
+    List<SignalProfile*>::const_iterator it;
+    for (it = profiles.begin(); it != profiles.end(); ++it) {
+        const SignalProfile *const profile = *it;
+        SignalStats signalStats;
+        signalStats.name = profile->m_name;
+        signalStats.signature = profile->m_signature;
+        signalStats.emissions = profile->m_emissions.load(std::memory_order_relaxed);
+        signalStats.slotCalls = profile->m_slotCalls.load(std::memory_order_relaxed);
+        signalStats.maxSlots = profile->m_maxSlots.load(std::memory_order_relaxed);
+        signalStats.slotTime = profile->m_slotTime.load(std::memory_order_relaxed) / 1000;
+        res.push_back(signalStats);
+    }
+#endif
+    return res;
+}
+
+#ifdef IDEAL_SIGNAL_PROFILING
+static bool slotTimeGreaterThan(const Application::SignalStats &left, const Application::SignalStats &right)
+{
+    return left.slotTime > right.slotTime;
+}
+#endif
+
+void Application::dumpSignalStats() const
+{
+#ifdef IDEAL_SIGNAL_PROFILING
+    const List<SignalStats> stats = signalStats();
+    std::vector<SignalStats> sortedStats(stats.begin(), stats.end());
+    std::stable_sort(sortedStats.begin(), sortedStats.end(), slotTimeGreaterThan);
+    ContextMutexLocker cml(outputMutex);
+    std::cerr << "signal\temissions\tslot calls\tmax slots\tslot time (us)" << std::endl;
+    std::vector<SignalStats>::const_iterator it;
+    for (it = sortedStats.begin(); it != sortedStats.end(); ++it) {
+        std::cerr << (*it).name.data() << '(' << (*it).signature.data() << ")\t" << (*it).emissions << '\t'
+                  << (*it).slotCalls << '\t' << (*it).maxSlots << '\t' << (*it).slotTime << std::endl;
+    }
+#else
+    IDEAL_DEBUG_WARNING("signal statistics are not available. Configure with --signal-profiling to collect them");
+#endif
+}
+
+List<Application::MutexStats> Application::mutexStats() const
+{
+    List<MutexStats> res;
+#ifdef IDEAL_MUTEX_PROFILING
+    List<MutexProfile*> profiles = MutexProfile::profiles();
+    List<MutexProfile*>::const_iterator it;
+    for (it = profiles.begin(); it != profiles.end(); ++it) {
+        const MutexProfile *const profile = *it;
+        MutexStats mutexStats;
+        mutexStats.file = profile->m_file;
+        mutexStats.line = profile->m_line;
+        mutexStats.acquisitions = profile->m_acquisitions.load(std::memory_order_relaxed);
+        mutexStats.contentions = profile->m_contentions.load(std::memory_order_relaxed);
+        mutexStats.waitTime = profile->m_waitTime.load(std::memory_order_relaxed) / 1000;
+        mutexStats.maxHoldTime = profile->m_maxHoldTime.load(std::memory_order_relaxed) / 1000;
+        res.push_back(mutexStats);
+    }
+#endif
+    return res;
+}
+
+#ifdef IDEAL_MUTEX_PROFILING
+static bool waitTimeGreaterThan(const Application::MutexStats &left, const Application::MutexStats &right)
+{
+    return left.waitTime > right.waitTime;
+}
+#endif
+
+void Application::dumpMutexStats() const
+{
+#ifdef IDEAL_MUTEX_PROFILING
+    const List<MutexStats> stats = mutexStats();
+    std::vector<MutexStats> sortedStats(stats.begin(), stats.end());
+    std::stable_sort(sortedStats.begin(), sortedStats.end(), waitTimeGreaterThan);
+    ContextMutexLocker cml(outputMutex);
+    std::cerr << "mutex\tacquisitions\tcontentions\twait time (us)\tmax hold time (us)" << std::endl;
+    std::vector<MutexStats>::const_iterator it;
+    for (it = sortedStats.begin(); it != sortedStats.end(); ++it) {
+        std::cerr << (*it).file.data() << ':' << (*it).line << '\t' << (*it).acquisitions << '\t'
+                  << (*it).contentions << '\t' << (*it).waitTime << '\t' << (*it).maxHoldTime << std::endl;
+    }
+#else
+    IDEAL_DEBUG_WARNING("mutex statistics are not available. Configure with --mutex-profiling to collect them");
+#endif
+}
+
+void Application::postEvent(Event *event, EventDispatcher *eventDispatcher)
+{
+    d->m_eventDispatcherPool.postEvent(event, eventDispatcher);
+}
+
+bool Application::tryPostEvent(Event *event, EventDispatcher *eventDispatcher)
+{
+    return d->m_eventDispatcherPool.tryPostEvent(event, eventDispatcher);
+}
+
 }
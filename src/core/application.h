@@ -35,6 +35,9 @@
   */
 namespace IdealCore {
 
+class Event;
+class EventDispatcher;
+
 /**
   * @class Application application.h core/application.h
   *
@@ -106,6 +109,49 @@ public:
         FailNormally       ///< May generate screen output.
     };
 
+    /**
+      * Statistics of a worker of the dispatcher pool.
+      *
+      * @see dispatcherStats
+      */
+    struct DispatcherStats {
+        iuint64 eventsDispatched; ///< The number of events this worker has dispatched
+        iuint64 busyTime;         ///< The time spent dispatching events, in microseconds
+        bool    busy;             ///< Whether this worker is dispatching an event right now
+    };
+
+    /**
+      * Statistics of all the signals sharing a name and signature, such as all the "timeout"
+      * signals of every Timer. Only collected when the library was configured with
+      * --signal-profiling.
+      *
+      * @see signalStats
+      */
+    struct SignalStats {
+        String  name;      ///< The name of the signal
+        String  signature; ///< The types of the parameters of the signal
+        iuint64 emissions; ///< The number of times these signals have been emitted
+        iuint64 slotCalls; ///< The number of slots that were connected on each emission, added up
+        iuint64 maxSlots;  ///< The largest number of slots connected on a single emission
+        iuint64 slotTime;  ///< The time spent on emissions calling slots, in microseconds
+    };
+
+    /**
+      * Statistics of all the mutexes created at the same place of the source code, such as the
+      * mutex of every Object. Only collected when the library was configured with
+      * --mutex-profiling.
+      *
+      * @see mutexStats
+      */
+    struct MutexStats {
+        String  file;         ///< The source file the mutexes were created at
+        iint32  line;         ///< The line of @p file the mutexes were created at
+        iuint64 acquisitions; ///< The number of times these mutexes have been locked
+        iuint64 contentions;  ///< The number of times these mutexes were already locked when trying to lock them
+        iuint64 waitTime;     ///< The time spent waiting for these mutexes to be unlocked, in microseconds
+        iuint64 maxHoldTime;  ///< The longest time one of these mutexes was kept locked, in microseconds
+    };
+
     enum Path {
         Global = 0,  ///< Environment variable $PATH
         Library,     ///< Environment variable $LD_LIBRARY_PATH
@@ -218,6 +264,87 @@ public:
       */
     void quit();
 
+    /**
+      * Sets the number of worker threads that dispatch events, such as timer timeouts. Workers are
+      * only started when the first event is posted.
+      *
+      * @note 4 by default.
+      */
+    void setDispatcherPoolSize(iint32 size);
+
+    /**
+      * @return The number of worker threads that dispatch events.
+      */
+    iint32 dispatcherPoolSize() const;
+
+    /**
+      * Sets the maximum number of events waiting to be dispatched. When the queue is full, the
+      * thread posting a new event will block until a worker is available.
+      *
+      * @note 1024 by default.
+      */
+    void setDispatcherQueueDepth(iint32 depth);
+
+    /**
+      * @return The maximum number of events waiting to be dispatched.
+      */
+    iint32 dispatcherQueueDepth() const;
+
+    /**
+      * @return The number of events currently waiting to be dispatched.
+      */
+    iint32 pendingEvents() const;
+
+    /**
+      * @return The statistics of each of the workers of the dispatcher pool. Workers removed by
+      *         shrinking the pool with setDispatcherPoolSize() are not included.
+      */
+    List<DispatcherStats> dispatcherStats() const;
+
+    /**
+      * @return The statistics of every signal that has been created so far, or an empty list if
+      *         the library was not configured with --signal-profiling.
+      *
+      * @note Time spent on a slot that emits another signal is accounted for both signals.
+      */
+    List<SignalStats> signalStats() const;
+
+    /**
+      * Writes signalStats() to the standard error output, sorted by slot time, so the signals that
+      * are keeping the application busy show up first.
+      */
+    void dumpSignalStats() const;
+
+    /**
+      * @return The statistics of every mutex that has been created so far, or an empty list if
+      *         the library was not configured with --mutex-profiling.
+      *
+      * @note Mutexes that are members of a class are accounted to the constructor of that class.
+      */
+    List<MutexStats> mutexStats() const;
+
+    /**
+      * Writes mutexStats() to the standard error output, sorted by wait time, so the most
+      * contended mutexes show up first.
+      */
+    void dumpMutexStats() const;
+
+    /**
+      * @internal
+      *
+      * Queues @p event on the dispatcher pool. @p eventDispatcher will handle it from one of the
+      * workers, or the default dispatcher if 0. The ownership of @p event is transferred.
+      */
+    void postEvent(Event *event, EventDispatcher *eventDispatcher = 0);
+
+    /**
+      * @internal
+      *
+      * Like postEvent(), but returns false instead of blocking when the queue is full. In that
+      * case the ownership of @p event is not transferred.
+      */
+    bool tryPostEvent(Event *event, EventDispatcher *eventDispatcher = 0);
+
 public:
     /**
       * Signal emitted when an invalid option has been given to the arguments of the application.
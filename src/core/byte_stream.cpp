@@ -19,6 +19,7 @@
  */
 
 #include "byte_stream.h"
+#include "ref_count.h"
 
 #include <string.h>
 
@@ -36,15 +37,17 @@ public:
     void ref();
     void deref();
 
+    /**
+      * @return The data shared by all empty byte streams, which is never deleted.
+      */
+    static Private *sharedEmpty();
     static Private *empty();
 
     void init(const ichar *data, size_t nbytes = 0);
 
-    ichar  *m_data;
-    size_t  m_size;
-    size_t  m_refs;
-
-    static Private *m_privateEmpty;
+    ichar    *m_data;
+    size_t    m_size;
+    RefCount  m_refs;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -63,11 +66,9 @@ ByteStream::Private::~Private()
 
 void ByteStream::Private::newAndDetach(ByteStream *byteStream)
 {
-    if (m_refs > 1) {
+    if (m_refs.isShared()) {
         byteStream->d = new Private;
         deref();
-    } else if (this == m_privateEmpty) {
-        m_privateEmpty = 0;
     } else {
         clearContents();
     }
@@ -82,28 +83,27 @@ void ByteStream::Private::clearContents()
 
 void ByteStream::Private::ref()
 {
-    ++m_refs;
+    m_refs.ref();
 }
 
 void ByteStream::Private::deref()
 {
-    --m_refs;
-    if (!m_refs) {
-        if (this == m_privateEmpty) {
-            m_privateEmpty = 0;
-        }
+    if (m_refs.deref()) {
         delete this;
     }
 }
 
+ByteStream::Private *ByteStream::Private::sharedEmpty()
+{
+    static Private *const privateEmpty = new Private;
+    return privateEmpty;
+}
+
 ByteStream::Private *ByteStream::Private::empty()
 {
-    if (!m_privateEmpty) {
-        m_privateEmpty = new Private;
-    } else {
-        m_privateEmpty->ref();
-    }
-    return m_privateEmpty;
+    Private *const res = sharedEmpty();
+    res->ref();
+    return res;
 }
 
 void ByteStream::Private::init(const ichar *data, size_t nbytes)
@@ -119,8 +119,6 @@ void ByteStream::Private::init(const ichar *data, size_t nbytes)
     }
 }
 
-ByteStream::Private *ByteStream::Private::m_privateEmpty = 0;
-
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 ByteStream::ByteStream()
@@ -0,0 +1,252 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "connection.h"
+
+#include <core/mutex.h>
+
+#include <new>
+#include <stdlib.h>
+
+namespace IdealCore {
+
+namespace {
+
+enum {
+    Granularity = 32,     ///< Size class i holds blocks of (i + 1) * Granularity bytes
+    SizeClasses = 8,
+    MaxBlockSize = Granularity * SizeClasses,
+    SlabSize = 16384,
+    BatchSize = 32,       ///< Blocks moved at once between a thread and the shared free lists
+    MaxCachedBlocks = 128 ///< Blocks a thread keeps per size class before giving some back
+};
+
+struct FreeBlock
+{
+    FreeBlock *m_next;
+};
+
+struct SizeClass
+{
+    SizeClass()
+        : m_freeList(0)
+    {
+    }
+
+    Mutex      m_mutex;
+    FreeBlock *m_freeList;
+};
+
+SizeClass *sharedSizeClasses()
+{
+    static SizeClass sizeClasses[SizeClasses];
+    return sizeClasses;
+}
+
+/**
+  * Moves up to @p count blocks from @p from to @p to.
+  *
+  * @return The number of blocks moved.
+  */
+iint32 moveBlocks(FreeBlock *&from, FreeBlock *&to, iint32 count)
+{
+    iint32 moved = 0;
+    while (from && moved < count) {
+        FreeBlock *const block = from;
+        from = block->m_next;
+        block->m_next = to;
+        to = block;
+        ++moved;
+    }
+    return moved;
+}
+
+/**
+  * @return A list with the blocks of a new slab, of size class @p sizeClass. Slabs are never given
+  *         back; they are reused through the free lists.
+  */
+FreeBlock *newSlab(iint32 sizeClass, iint32 &count)
+{
+    const size_t blockSize = (sizeClass + 1) * Granularity;
+    ichar *const slab = static_cast<ichar*>(malloc(SlabSize));
+    if (!slab) {
+        throw std::bad_alloc();
+    }
+    FreeBlock *res = 0;
+    count = 0;
+    for (size_t offset = 0; offset + blockSize <= SlabSize; offset += blockSize) {
+        FreeBlock *const block = reinterpret_cast<FreeBlock*>(slab + offset);
+        block->m_next = res;
+        res = block;
+        ++count;
+    }
+    return res;
+}
+
+/**
+  * Used by threads whose cache is already gone, for instance from thread local destructors run
+  * after the one of the cache.
+  */
+void *sharedAllocate(iint32 sizeClass)
+{
+    SizeClass &shared = sharedSizeClasses()[sizeClass];
+    ContextMutexLocker cml(shared.m_mutex);
+    if (!shared.m_freeList) {
+        iint32 count;
+        shared.m_freeList = newSlab(sizeClass, count);
+    }
+    FreeBlock *const block = shared.m_freeList;
+    shared.m_freeList = block->m_next;
+    return block;
+}
+
+void sharedDeallocate(void *ptr, iint32 sizeClass)
+{
+    FreeBlock *const block = static_cast<FreeBlock*>(ptr);
+    SizeClass &shared = sharedSizeClasses()[sizeClass];
+    ContextMutexLocker cml(shared.m_mutex);
+    block->m_next = shared.m_freeList;
+    shared.m_freeList = block;
+}
+
+class ThreadCache
+{
+public:
+    ThreadCache()
+    {
+        for (iint32 i = 0; i < SizeClasses; ++i) {
+            m_freeLists[i] = 0;
+            m_freeCount[i] = 0;
+        }
+    }
+
+    ~ThreadCache()
+    {
+        for (iint32 i = 0; i < SizeClasses; ++i) {
+            release(i, m_freeCount[i]);
+        }
+    }
+
+    void *allocate(iint32 sizeClass)
+    {
+        if (!m_freeLists[sizeClass]) {
+            refill(sizeClass);
+        }
+        FreeBlock *const block = m_freeLists[sizeClass];
+        m_freeLists[sizeClass] = block->m_next;
+        --m_freeCount[sizeClass];
+        return block;
+    }
+
+    void deallocate(void *ptr, iint32 sizeClass)
+    {
+        FreeBlock *const block = static_cast<FreeBlock*>(ptr);
+        block->m_next = m_freeLists[sizeClass];
+        m_freeLists[sizeClass] = block;
+        if (++m_freeCount[sizeClass] > MaxCachedBlocks) {
+            release(sizeClass, BatchSize);
+        }
+    }
+
+private:
+    void refill(iint32 sizeClass)
+    {
+        SizeClass &shared = sharedSizeClasses()[sizeClass];
+        {
+            ContextMutexLocker cml(shared.m_mutex);
+            m_freeCount[sizeClass] += moveBlocks(shared.m_freeList, m_freeLists[sizeClass], BatchSize);
+        }
+        if (m_freeLists[sizeClass]) {
+            return;
+        }
+        m_freeLists[sizeClass] = newSlab(sizeClass, m_freeCount[sizeClass]);
+    }
+
+    void release(iint32 sizeClass, iint32 count)
+    {
+        SizeClass &shared = sharedSizeClasses()[sizeClass];
+        ContextMutexLocker cml(shared.m_mutex);
+        m_freeCount[sizeClass] -= moveBlocks(m_freeLists[sizeClass], shared.m_freeList, count);
+    }
+
+    FreeBlock *m_freeLists[SizeClasses];
+    iint32     m_freeCount[SizeClasses];
+};
+
+// Both are trivially destructible, so they can still be read after the destructor of
+// threadCacheOwner has run
+thread_local ThreadCache *threadCache = 0;
+thread_local bool threadCacheDestroyed = false;
+
+class ThreadCacheOwner
+{
+public:
+    ~ThreadCacheOwner()
+    {
+        delete threadCache;
+        threadCache = 0;
+        threadCacheDestroyed = true;
+    }
+};
+
+thread_local ThreadCacheOwner threadCacheOwner;
+
+/**
+  * @return The cache of the calling thread, or 0 if it was already destroyed.
+  */
+ThreadCache *localThreadCache()
+{
+    if (!threadCache && !threadCacheDestroyed) {
+        threadCache = new ThreadCache;
+        // Makes sure the owner is constructed, so it deletes the cache when the thread exits
+        (void) &threadCacheOwner;
+    }
+    return threadCache;
+}
+
+}
+
+void *CallbackAllocator::allocate(size_t size)
+{
+    if (size > MaxBlockSize) {
+        return ::operator new(size);
+    }
+    ThreadCache *const cache = localThreadCache();
+    if (!cache) {
+        return sharedAllocate((size - 1) / Granularity);
+    }
+    return cache->allocate((size - 1) / Granularity);
+}
+
+void CallbackAllocator::deallocate(void *ptr, size_t size)
+{
+    if (size > MaxBlockSize) {
+        ::operator delete(ptr);
+        return;
+    }
+    ThreadCache *const cache = localThreadCache();
+    if (!cache) {
+        sharedDeallocate(ptr, (size - 1) / Granularity);
+        return;
+    }
+    cache->deallocate(ptr, (size - 1) / Granularity);
+}
+
+}
@@ -0,0 +1,186 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef CONNECTION_H
+#define CONNECTION_H
+
+#include <ideal_export.h>
+#include <core/signal_resource.h>
+
+#include <atomic>
+#include <cstddef>
+
+namespace IdealCore {
+
+/**
+  * @internal
+  *
+  * Allocates the small objects signals are made of (callbacks, connection snapshots, guards)
+  * without going through malloc. Blocks are taken from per-size-class slabs and cached on free
+  * lists owned by each thread, so connecting and disconnecting usually does not take any lock.
+  * Sizes bigger than the largest size class are passed through to the global operator new.
+  */
+class IDEAL_EXPORT CallbackAllocator
+{
+public:
+    static void *allocate(size_t size);
+    static void deallocate(void *ptr, size_t size);
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  */
+class CallbackDummy
+{
+public:
+    CallbackDummy()
+        : m_refs(1)
+        , m_disconnected(false)
+        , m_threadSafe(false)
+    {
+    }
+
+    virtual ~CallbackDummy()
+    {
+        m_receiver = 0;
+    }
+
+    static void *operator new(size_t size)
+    {
+        return CallbackAllocator::allocate(size);
+    }
+
+    static void operator delete(void *ptr, size_t size)
+    {
+        CallbackAllocator::deallocate(ptr, size);
+    }
+
+    void ref()
+    {
+        m_refs.fetch_add(1);
+    }
+
+    void deref()
+    {
+        if (m_refs.fetch_sub(1) == 1) {
+            delete this;
+        }
+    }
+
+    SignalResource     *m_receiver;
+    std::atomic<iint32> m_refs;         ///< One for the signal, plus one per snapshot or Connection holding it
+    std::atomic<bool>   m_disconnected; ///< Emissions skip it, and the signal drops it when it is found
+    bool                m_threadSafe;   ///< Whether parallel emissions can call it from any thread
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @class Connection connection.h core/connection.h
+  *
+  * A handle to a connection between a signal and a slot, as returned by the connect methods of
+  * signals. Disconnecting through the handle is a constant time operation, no matter how many
+  * connections the signal has. Example:
+  *
+  * @code
+  * Connection connection = myObject->mySignal.connect(receiver, &Receiver::mySlot);
+  * ...
+  * connection.disconnect();
+  * @endcode
+  *
+  * @note Destroying the handle does not disconnect.
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class Connection
+{
+public:
+    /**
+      * Creates a handle that does not refer to any connection.
+      */
+    Connection()
+        : m_callback(0)
+    {
+    }
+
+    /**
+      * @internal
+      */
+    Connection(CallbackDummy *callback)
+        : m_callback(callback)
+    {
+        m_callback->ref();
+    }
+
+    Connection(const Connection &connection)
+        : m_callback(connection.m_callback)
+    {
+        if (m_callback) {
+            m_callback->ref();
+        }
+    }
+
+    ~Connection()
+    {
+        if (m_callback) {
+            m_callback->deref();
+        }
+    }
+
+    Connection &operator=(const Connection &connection)
+    {
+        if (connection.m_callback) {
+            connection.m_callback->ref();
+        }
+        if (m_callback) {
+            m_callback->deref();
+        }
+        m_callback = connection.m_callback;
+        return *this;
+    }
+
+    /**
+      * Disconnects the slot from the signal. It can be called from any thread, even if the signal
+      * or the receiver have already been destroyed.
+      */
+    void disconnect()
+    {
+        if (m_callback) {
+            m_callback->m_disconnected.store(true);
+        }
+    }
+
+    /**
+      * @return Whether the slot is still connected to the signal.
+      */
+    bool isConnected() const
+    {
+        return m_callback && !m_callback->m_disconnected.load();
+    }
+
+private:
+    CallbackDummy *m_callback;
+};
+
+}
+
+#endif //CONNECTION_H
@@ -18,26 +18,19 @@
  * Boston, MA 02110-1301, USA.
  */
 
-#ifndef MUTEX_P_H_POSIX
-#define MUTEX_P_H_POSIX
-
-#include <pthread.h>
-#include <core/private/mutex_p.h>
+#include "context_read_locker.h"
 
 namespace IdealCore {
 
-class Mutex::PrivateImpl
-    : public Mutex::Private
+ContextReadLocker::ContextReadLocker(ReadWriteLock &readWriteLock)
+    : m_readWriteLock(readWriteLock)
 {
-public:
-    PrivateImpl(RecursionType recursionType);
-    virtual ~PrivateImpl();
-
-    pthread_mutex_t     m_mutex;
-    pthread_mutexattr_t m_attr;
-};
-
+    m_readWriteLock.lockForRead();
 }
 
-#endif //MUTEX_P_H_POSIX
+ContextReadLocker::~ContextReadLocker()
+{
+    m_readWriteLock.unlockForRead();
+}
 
+}
@@ -18,38 +18,19 @@
  * Boston, MA 02110-1301, USA.
  */
 
-#include <core/mutex.h>
-#include "mutex_p.h"
+#include "context_write_locker.h"
 
 namespace IdealCore {
 
-Mutex::PrivateImpl::PrivateImpl(RecursionType recursionType)
+ContextWriteLocker::ContextWriteLocker(ReadWriteLock &readWriteLock)
+    : m_readWriteLock(readWriteLock)
 {
-    pthread_mutexattr_init(&m_attr);
-    if (recursionType == Recursive) {
-        pthread_mutexattr_settype(&m_attr, PTHREAD_MUTEX_RECURSIVE);
-    }
-    pthread_mutex_init(&m_mutex, &m_attr);
+    m_readWriteLock.lockForWrite();
 }
 
-Mutex::PrivateImpl::~PrivateImpl()
+ContextWriteLocker::~ContextWriteLocker()
 {
-    pthread_mutex_destroy(&m_mutex);
-}
-
-void Mutex::lock()
-{
-    pthread_mutex_lock(&D_I->m_mutex);
-}
-
-bool Mutex::tryLock()
-{
-    return !pthread_mutex_trylock(&D_I->m_mutex);
-}
-
-void Mutex::unlock()
-{
-    pthread_mutex_unlock(&D_I->m_mutex);
+    m_readWriteLock.unlockForWrite();
 }
 
 }
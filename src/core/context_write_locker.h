@@ -0,0 +1,58 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef CONTEXT_WRITE_LOCKER_H
+#define CONTEXT_WRITE_LOCKER_H
+
+#include <ideal_export.h>
+
+#include <core/read_write_lock.h>
+
+namespace IdealCore {
+
+/**
+  * @class ContextWriteLocker context_write_locker.h core/context_write_locker.h
+  *
+  * This class will lock the read-write lock for writing when created, and will unlock it when
+  * destroyed, the same way ContextMutexLocker does with a Mutex.
+  *
+  * @code
+  * void Class::modifyingMethod()
+  * {
+  *     ContextWriteLocker cwl(theLock);
+  *     // critical section here
+  * }
+  * @endcode
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class IDEAL_EXPORT ContextWriteLocker
+{
+public:
+    ContextWriteLocker(ReadWriteLock &readWriteLock);
+    virtual ~ContextWriteLocker();
+
+private:
+    ReadWriteLock &m_readWriteLock;
+};
+
+}
+
+#endif //CONTEXT_WRITE_LOCKER_H
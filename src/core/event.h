@@ -52,7 +52,8 @@ public:
         ConfigureNotify,
         Expose,
         FocusIn,
-        FocusOut
+        FocusOut,
+        Emission
     };
 
     Event(Object *object, Type type);
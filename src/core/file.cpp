@@ -22,6 +22,8 @@
 #include "private/file_p.h"
 
 #include "extension_loader.h"
+#include "context_read_locker.h"
+#include "context_write_locker.h"
 
 #include "application.h"
 #include "private/application_p.h"
@@ -60,11 +62,25 @@ ProtocolHandler *File::Private::findProtocolHandler()
 {
     Application::Private *const app_d = q->application()->d;
     List<ProtocolHandler*>::iterator it;
+    // The cache is walked for reading, so lookups do not wait for each other. Only when a handler
+    // can be reused the lock is taken for writing, to take it out of the cache
+    ProtocolHandler *candidate = 0;
     {
-        ContextMutexLocker cml(app_d->m_protocolHandlerCacheMutex);
+        ContextReadLocker crl(app_d->m_protocolHandlerCacheLock);
+        for (it = app_d->m_protocolHandlerCache.begin(); it != app_d->m_protocolHandlerCache.end(); ++it) {
+            if ((*it)->canBeReusedWith(q->d->m_uri)) {
+                candidate = *it;
+                break;
+            }
+        }
+    }
+    if (candidate) {
+        ContextWriteLocker cwl(app_d->m_protocolHandlerCacheLock);
+        // Other thread could have taken or discarded it meanwhile, and a new handler could live
+        // at the same address
         for (it = app_d->m_protocolHandlerCache.begin(); it != app_d->m_protocolHandlerCache.end(); ++it) {
             ProtocolHandler *protocolHandler = *it;
-            if (protocolHandler->canBeReusedWith(q->d->m_uri)) {
+            if (protocolHandler == candidate && protocolHandler->canBeReusedWith(q->d->m_uri)) {
                 app_d->m_protocolHandlerCache.erase(it);
                 ++protocolHandler->m_weight;
                 return protocolHandler;
@@ -126,6 +142,8 @@ File::Private::Job::Job(File *file, Type type)
     , m_maxBytes(NoMaxBytes)
     , m_protocolHandler(0)
 {
+    // Jobs are short-lived and started often, there is no point in creating a thread for each one
+    setPooled(true);
 }
 
 void File::Private::Job::cacheOrDiscard(ProtocolHandler *protocolHandler)
@@ -134,7 +152,7 @@ void File::Private::Job::cacheOrDiscard(ProtocolHandler *protocolHandler)
         return;
     }
     Application::Private *const app_d = m_file->application()->d;
-    ContextMutexLocker cml(app_d->m_protocolHandlerCacheMutex);
+    ContextWriteLocker cwl(app_d->m_protocolHandlerCacheLock);
     if (app_d->m_protocolHandlerCache.size() < PH_CACHE_SIZE) {
         app_d->m_protocolHandlerCache.push_back(protocolHandler);
     } else {
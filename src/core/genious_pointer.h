@@ -22,10 +22,56 @@
 #define GENIOUS_POINTER_H
 
 #include <ideal_export.h>
-#include <core/signal_resource.h>
+#include <core/connection.h>
+
+#include <atomic>
 
 namespace IdealCore {
 
+/**
+  * @internal
+  *
+  * Tells whether an object is still alive. It is created the first time a GeniousPointer points to
+  * the object, and shared by the object and all those pointers, so it outlives the object as long
+  * as somebody can still ask.
+  */
+class ObjectGuard
+{
+public:
+    ObjectGuard()
+        : m_refs(1)
+        , m_destroyed(false)
+    {
+    }
+
+    static void *operator new(size_t size)
+    {
+        return CallbackAllocator::allocate(size);
+    }
+
+    static void operator delete(void *ptr, size_t size)
+    {
+        CallbackAllocator::deallocate(ptr, size);
+    }
+
+    void ref()
+    {
+        m_refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void deref()
+    {
+        if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    std::atomic<iint32> m_refs;
+    std::atomic<bool>   m_destroyed; ///< Stored with release when the object starts being destroyed
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /**
   * @class GeniousPointer genious_pointer.h core/genious_pointer.h
   *
@@ -41,13 +87,15 @@ namespace IdealCore {
   * myPointer->someMethod(); // error, myPointer is pointing to 0
   * @endcode
   *
+  * Copying a genious pointer or checking its content only touches a reference counted guard
+  * shared with the object, so it is cheap enough to do it often.
+  *
   * @note For this to work, T class has to inherit IdealCore::Object.
   *
   * @author Rafael Fernández López <ereslibre@ereslibre.es>
   */
 template <typename T>
 class GeniousPointer
-    : public SignalResource
 {
 public:
     /**
@@ -62,12 +110,7 @@ public:
     /**
       * @note This will not destroy the contents.
       */
-    virtual ~GeniousPointer();
-
-    /**
-      * @internal
-      */
-    void contentDestroyed();
+    ~GeniousPointer();
 
     /**
       * @return The content. 0 if the content was destroyed.
@@ -90,13 +133,9 @@ public:
       */
     bool isContentDestroyed() const;
 
-    /**
-      * @internal
-      */
-    bool areSignalsBlocked() const;
-
 private:
-    T *m_t;
+    T           *m_t;
+    ObjectGuard *m_guard;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -104,72 +143,58 @@ private:
 template <typename T>
 GeniousPointer<T>::GeniousPointer(T *content)
     : m_t(content)
+    , m_guard(content ? content->guard() : 0)
 {
-    if (m_t) {
-        m_t->destroyed.connect(this, &GeniousPointer<T>::contentDestroyed);
-    }
 }
 
 template <typename T>
 GeniousPointer<T>::GeniousPointer(const GeniousPointer &ptr)
     : m_t(ptr.m_t)
+    , m_guard(ptr.m_guard)
 {
-    if (m_t) {
-        m_t->destroyed(this, &GeniousPointer<T>::contentDestroyed);
+    if (m_guard) {
+        m_guard->ref();
     }
 }
 
-
 template <typename T>
 GeniousPointer<T>::~GeniousPointer()
 {
-    if (m_t) {
-        m_t->destroyed.disconnect(this);
+    if (m_guard) {
+        m_guard->deref();
     }
- }
-
-template <typename T>
-void GeniousPointer<T>::contentDestroyed()
-{
-    m_t = 0;
 }
 
 template <typename T>
 T *GeniousPointer<T>::content() const
 {
-    return m_t;
+    return isContentDestroyed() ? 0 : m_t;
 }
 
 template <typename T>
 T *GeniousPointer<T>::operator->() const
 {
-    return m_t;
+    return content();
 }
 
 template <typename T>
 GeniousPointer<T> &GeniousPointer<T>::operator=(const GeniousPointer &ptr)
 {
-    if (m_t) {
-        m_t->destroyed.disconnect(this);
+    if (ptr.m_guard) {
+        ptr.m_guard->ref();
     }
-    m_t = ptr.m_t;
-    if (m_t) {
-        m_t->destroyed.connect(this, &GeniousPointer<T>::contentDestroyed);
+    if (m_guard) {
+        m_guard->deref();
     }
+    m_t = ptr.m_t;
+    m_guard = ptr.m_guard;
     return *this;
 }
 
-
 template <typename T>
 bool GeniousPointer<T>::isContentDestroyed() const
 {
-    return m_t == 0;
-}
-
-template <typename T>
-bool GeniousPointer<T>::areSignalsBlocked() const
-{
-    return false;
+    return !m_guard || m_guard->m_destroyed.load(std::memory_order_acquire);
 }
 
 }
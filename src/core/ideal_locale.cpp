@@ -35,13 +35,12 @@ Locale::Private::~Private()
 
 void Locale::Private::ref()
 {
-    ++m_refs;
+    m_refs.ref();
 }
 
 void Locale::Private::deref()
 {
-    --m_refs;
-    if (!m_refs) {
+    if (m_refs.deref()) {
         delete this;
     }
 }
@@ -0,0 +1,425 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <core/object.h>
+#include <core/event.h>
+#include <core/cond_var.h>
+#include <core/application.h>
+#include "private/event_dispatcher_p.h"
+
+#ifdef IDEAL_SIGNAL_PROFILING
+#include <core/timer.h>
+
+#include <map>
+#include <string>
+#endif
+
+#include <algorithm>
+
+namespace IdealCore {
+
+namespace {
+
+/**
+  * Where a thread announces the snapshot it is about to take a reference to. Slots are never
+  * freed; the slot of a finished thread is reused by the next one that needs it.
+  */
+struct HazardSlot
+{
+    std::atomic<ConnectionSnapshot*>  m_snapshot;
+    std::atomic<bool>                 m_inUse;
+    HazardSlot                       *m_next;     ///< Never changes once the slot is in the list
+};
+
+std::atomic<HazardSlot*> hazardSlots(0);
+
+HazardSlot *claimHazardSlot()
+{
+    for (HazardSlot *slot = hazardSlots.load(); slot; slot = slot->m_next) {
+        bool inUse = false;
+        if (!slot->m_inUse.load(std::memory_order_relaxed) && slot->m_inUse.compare_exchange_strong(inUse, true)) {
+            return slot;
+        }
+    }
+    HazardSlot *const slot = new HazardSlot;
+    slot->m_snapshot.store(0, std::memory_order_relaxed);
+    slot->m_inUse.store(true, std::memory_order_relaxed);
+    slot->m_next = hazardSlots.load();
+    while (!hazardSlots.compare_exchange_weak(slot->m_next, slot)) {
+    }
+    return slot;
+}
+
+void releaseHazardSlot(HazardSlot *slot)
+{
+    slot->m_inUse.store(false, std::memory_order_release);
+}
+
+bool isHazardous(ConnectionSnapshot *snapshot)
+{
+    for (HazardSlot *slot = hazardSlots.load(); slot; slot = slot->m_next) {
+        if (slot->m_snapshot.load() == snapshot) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Both are trivially destructible, so they can still be read after the destructor of
+// threadHazardSlotOwner has run
+thread_local HazardSlot *threadHazardSlot = 0;
+thread_local bool threadHazardSlotReleased = false;
+
+class ThreadHazardSlotOwner
+{
+public:
+    ~ThreadHazardSlotOwner()
+    {
+        releaseHazardSlot(threadHazardSlot);
+        threadHazardSlot = 0;
+        threadHazardSlotReleased = true;
+    }
+};
+
+thread_local ThreadHazardSlotOwner threadHazardSlotOwner;
+
+/**
+  * @return The slot of the calling thread, or 0 if it was already released.
+  */
+HazardSlot *localHazardSlot()
+{
+    if (!threadHazardSlot && !threadHazardSlotReleased) {
+        threadHazardSlot = claimHazardSlot();
+        // Makes sure the owner is constructed, so it releases the slot when the thread exits
+        (void) &threadHazardSlotOwner;
+    }
+    return threadHazardSlot;
+}
+
+/**
+  * Snapshots replaced while some thread was about to take a reference to them. Function-local,
+  * since signals can be destroyed during static destruction.
+  */
+struct RetiredSnapshots
+{
+    Mutex                     m_mutex;
+    List<ConnectionSnapshot*> m_snapshots;
+};
+
+RetiredSnapshots &retiredSnapshots()
+{
+    static RetiredSnapshots *const retired = new RetiredSnapshots;
+    return *retired;
+}
+
+/**
+  * Whether RetiredSnapshots has any snapshot. Set before looking for the threads announcing them,
+  * so a thread that stops announcing one afterwards sees it and reclaims it.
+  */
+std::atomic<bool> retiredSnapshotsPending(false);
+
+/**
+  * Drops the retired snapshots that no thread announces anymore, and @p snapshot, if not 0, in
+  * the same way.
+  */
+void reclaimSnapshots(ConnectionSnapshot *snapshot)
+{
+    // Snapshots are dropped outside of the lock, since that can destroy functors
+    List<ConnectionSnapshot*> unused;
+    {
+        RetiredSnapshots &retired = retiredSnapshots();
+        ContextMutexLocker cml(retired.m_mutex);
+        if (snapshot) {
+            retired.m_snapshots.push_back(snapshot);
+        }
+        retiredSnapshotsPending.store(true);
+        List<ConnectionSnapshot*>::iterator it = retired.m_snapshots.begin();
+        while (it != retired.m_snapshots.end()) {
+            if (isHazardous(*it)) {
+                ++it;
+                continue;
+            }
+            unused.push_back(*it);
+            it = retired.m_snapshots.erase(it);
+        }
+        retiredSnapshotsPending.store(!retired.m_snapshots.empty());
+    }
+    List<ConnectionSnapshot*>::iterator it;
+    for (it = unused.begin(); it != unused.end(); ++it) {
+        (*it)->deref();
+    }
+}
+
+}
+
+ConnectionSnapshot *ConnectionSnapshot::acquire(const std::atomic<ConnectionSnapshot*> &snapshot)
+{
+    HazardSlot *slot = localHazardSlot();
+    const bool temporarySlot = !slot;
+    if (temporarySlot) {
+        slot = claimHazardSlot();
+    }
+    // Once the announced snapshot is seen still stored after announcing it, whoever replaces it
+    // afterwards will see the announcement and keep its reference
+    ConnectionSnapshot *res = snapshot.load();
+    while (res && res != stale()) {
+        slot->m_snapshot.store(res);
+        ConnectionSnapshot *const current = snapshot.load();
+        if (current == res) {
+            res->ref();
+            break;
+        }
+        res = current;
+    }
+    slot->m_snapshot.store(0);
+    if (temporarySlot) {
+        releaseHazardSlot(slot);
+    }
+    // The snapshot this thread announced may have been retired meanwhile. Nobody else would drop
+    // it if connections do not change anymore
+    if (retiredSnapshotsPending.load()) {
+        reclaimSnapshots(0);
+    }
+    return res;
+}
+
+void ConnectionSnapshot::retire(ConnectionSnapshot *snapshot)
+{
+    if (!retiredSnapshotsPending.load() && !isHazardous(snapshot)) {
+        snapshot->deref();
+        return;
+    }
+    reclaimSnapshots(snapshot);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/**
+  * The part of a parallel emission shared with the helpers. Helpers may start after the emission
+  * has finished, so it is refcounted; they only call callbacks from chunks they manage to claim,
+  * and the emitter waits for all claimed chunks to be finished.
+  */
+class EmissionState
+    : public EventDispatcher
+{
+public:
+    enum {
+        ChunkSize = 8
+    };
+
+    EmissionState(ParallelEmission *parallelEmission, ConnectionSnapshot *snapshot)
+        : m_refs(1)
+        , m_parallelEmission(parallelEmission)
+        , m_snapshot(snapshot)
+        , m_nextIndex(0)
+        , m_finished(0)
+        , m_allFinished(m_mutex)
+    {
+        m_snapshot->ref();
+    }
+
+    virtual ~EmissionState()
+    {
+        m_snapshot->deref();
+    }
+
+    void ref()
+    {
+        m_refs.fetch_add(1);
+    }
+
+    void deref()
+    {
+        if (m_refs.fetch_sub(1) == 1) {
+            delete this;
+        }
+    }
+
+    /**
+      * Claims chunks and calls their thread-safe callbacks until there are no chunks left. Once the
+      * signal has been destroyed, the remaining chunks are claimed without calling anything, so
+      * waitForAll() still returns.
+      */
+    void processChunks()
+    {
+        const size_t count = m_snapshot->m_count;
+        const SignalGuard *const guard = m_snapshot->m_guard;
+        while (true) {
+            const bool destroyed = guard->m_destroyed.load();
+            const size_t first = m_nextIndex.fetch_add(ChunkSize);
+            if (first >= count) {
+                return;
+            }
+            const size_t last = std::min(first + ChunkSize, count);
+            for (size_t i = first; i < last && !destroyed; ++i) {
+                CallbackDummy *const callback = m_snapshot->m_callbacks[i];
+                if (callback->m_threadSafe && !callback->m_disconnected.load()) {
+                    m_parallelEmission->call(callback);
+                }
+            }
+            if (m_finished.fetch_add(last - first) + (last - first) == count) {
+                ContextMutexLocker cml(m_mutex);
+                m_allFinished.broadcast();
+            }
+        }
+    }
+
+    void waitForAll()
+    {
+        ContextMutexLocker cml(m_mutex);
+        while (m_finished.load() < m_snapshot->m_count) {
+            m_allFinished.wait();
+        }
+    }
+
+    virtual void dispatchEvent(Event *event)
+    {
+        processChunks();
+        deref();
+    }
+
+private:
+    std::atomic<iint32>       m_refs;
+    ParallelEmission   *const m_parallelEmission;
+    ConnectionSnapshot *const m_snapshot;
+    std::atomic<size_t>       m_nextIndex;
+    std::atomic<size_t>       m_finished;
+    Mutex                     m_mutex;
+    CondVar                   m_allFinished;
+};
+
+}
+
+ParallelEmission::~ParallelEmission()
+{
+}
+
+void ParallelEmission::run(SignalResource *parent, ConnectionSnapshot *snapshot)
+{
+    EmissionState *const emissionState = new EmissionState(this, snapshot);
+    Object *const object = dynamic_cast<Object*>(parent);
+    Application *const application = object ? object->application() : 0;
+    if (application) {
+        const size_t chunks = (snapshot->m_count + EmissionState::ChunkSize - 1) / EmissionState::ChunkSize;
+        const size_t helpers = std::min((size_t) std::max(application->dispatcherPoolSize(), 0), chunks - 1);
+        // Helpers are only an optimization, since the emitter processes chunks too. Posting does
+        // not block, since this can run on a dispatcher worker waiting for its own queue
+        for (size_t i = 0; i < helpers; ++i) {
+            Event *const event = new Event(object, Event::Emission);
+            emissionState->ref();
+            if (!application->tryPostEvent(event, emissionState)) {
+                emissionState->deref();
+                delete event;
+                break;
+            }
+        }
+    }
+    // Callbacks that are not thread-safe are called from here while the helpers start working
+    const SignalGuard *const guard = snapshot->m_guard;
+    for (size_t i = 0; i < snapshot->m_count && !guard->m_destroyed.load(); ++i) {
+        CallbackDummy *const callback = snapshot->m_callbacks[i];
+        if (!callback->m_threadSafe && !callback->m_disconnected.load()) {
+            call(callback);
+        }
+    }
+    emissionState->processChunks();
+    emissionState->waitForAll();
+    emissionState->deref();
+}
+
+#ifdef IDEAL_SIGNAL_PROFILING
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/**
+  * Profiles by "name(signature)". Function-local, since signals can be created during static
+  * initialization.
+  */
+struct SignalProfileRegistry {
+    Mutex                                 m_mutex;
+    std::map<std::string, SignalProfile*> m_profiles;
+};
+
+SignalProfileRegistry &signalProfileRegistry()
+{
+    static SignalProfileRegistry *const registry = new SignalProfileRegistry;
+    return *registry;
+}
+
+}
+
+SignalProfile::SignalProfile(const ichar *name, const ichar *signature)
+    : m_name(name)
+    , m_signature(signature)
+    , m_emissions(0)
+    , m_slotCalls(0)
+    , m_maxSlots(0)
+    , m_slotTime(0)
+{
+}
+
+SignalProfile *SignalProfile::get(const ichar *name, const ichar *signature)
+{
+    const std::string key = std::string(name) + '(' + signature + ')';
+    SignalProfileRegistry &registry = signalProfileRegistry();
+    ContextMutexLocker cml(registry.m_mutex);
+    SignalProfile *&profile = registry.m_profiles[key];
+    if (!profile) {
+        profile = new SignalProfile(name, signature);
+    }
+    return profile;
+}
+
+List<SignalProfile*> SignalProfile::profiles()
+{
+    List<SignalProfile*> res;
+    SignalProfileRegistry &registry = signalProfileRegistry();
+    ContextMutexLocker cml(registry.m_mutex);
+    std::map<std::string, SignalProfile*>::const_iterator it;
+    for (it = registry.m_profiles.begin(); it != registry.m_profiles.end(); ++it) {
+        res.push_back(it->second);
+    }
+    return res;
+}
+
+void SignalProfile::Emission::start(size_t slots)
+{
+    m_slots = slots;
+    m_start = Timer::monotonicTime();
+}
+
+SignalProfile::Emission::~Emission()
+{
+    m_profile->m_emissions.fetch_add(1, std::memory_order_relaxed);
+    if (!m_slots) {
+        return;
+    }
+    m_profile->m_slotTime.fetch_add(Timer::monotonicTime() - m_start, std::memory_order_relaxed);
+    m_profile->m_slotCalls.fetch_add(m_slots, std::memory_order_relaxed);
+    iuint64 maxSlots = m_profile->m_maxSlots.load(std::memory_order_relaxed);
+    while (maxSlots < m_slots && !m_profile->m_maxSlots.compare_exchange_weak(maxSlots, m_slots, std::memory_order_relaxed)) {
+    }
+}
+#endif
+
+}
@@ -21,30 +21,248 @@
 #ifndef IDEAL_SIGNAL_H
 #define IDEAL_SIGNAL_H
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <tuple>
+#include <type_traits>
+
 #include <core/mutex.h>
 #include <core/list.h>
 #include <core/signal_resource.h>
+#include <core/connection.h>
+#include <core/genious_pointer.h>
 
 namespace IdealCore {
 
 class Object;
 class SignalBase;
 
-static List<SignalBase*> deletedSignalsOnEmit;
-static Mutex deletedSignalsOnEmitMutex;
+/**
+  * @internal
+  *
+  * Tells emissions in progress that their signal has been destroyed by one of the slots. It is
+  * shared by the signal and all its snapshots, so it outlives the signal while it is being emitted.
+  */
+class SignalGuard
+{
+public:
+    SignalGuard()
+        : m_refs(1)
+        , m_destroyed(false)
+    {
+    }
+
+    static void *operator new(size_t size)
+    {
+        return CallbackAllocator::allocate(size);
+    }
+
+    static void operator delete(void *ptr, size_t size)
+    {
+        CallbackAllocator::deallocate(ptr, size);
+    }
+
+    void ref()
+    {
+        m_refs.fetch_add(1);
+    }
+
+    void deref()
+    {
+        if (m_refs.fetch_sub(1) == 1) {
+            delete this;
+        }
+    }
+
+    std::atomic<iint32> m_refs;
+    std::atomic<bool>   m_destroyed;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /**
   * @internal
+  *
+  * An immutable copy of the connections of a signal. A new one is built every time a connection is
+  * made or removed, so emitting only needs to take a reference to the current one instead of
+  * copying the connections. Every snapshot holds a reference to each of its callbacks.
+  *
+  * A signal holds a reference to its current snapshot. Emitters announce the snapshot they are
+  * about to take a reference to in a slot of their own thread, and a replaced snapshot is only
+  * dropped by its signal once no thread announces it. Neither side ever waits for the other.
   */
-class CallbackDummy
+class IDEAL_EXPORT ConnectionSnapshot
 {
 public:
-    virtual ~CallbackDummy()
+    /**
+      * Creates a snapshot of @p connections, in a single allocation.
+      */
+    static ConnectionSnapshot *create(const List<CallbackDummy*> &connections, SignalGuard *guard)
     {
-        m_receiver = 0;
+        void *const ptr = CallbackAllocator::allocate(allocationSize(connections.size()));
+        return new (ptr) ConnectionSnapshot(connections, guard);
     }
 
-    SignalResource *m_receiver;
+    /**
+      * @return A reference to the snapshot stored in @p snapshot, that has to be deref()'ed when
+      *         done. If it holds 0 or stale(), that is returned instead.
+      */
+    static ConnectionSnapshot *acquire(const std::atomic<ConnectionSnapshot*> &snapshot);
+
+    /**
+      * Drops the reference a signal held to @p snapshot, after replacing it. If some thread is
+      * about to take a reference to it, this is postponed to a later call.
+      */
+    static void retire(ConnectionSnapshot *snapshot);
+
+    /**
+      * @return A marker stored by signals instead of their snapshot while it is out of date. It
+      *         does not point to a snapshot, and it is the same no matter which library or
+      *         application asks.
+      */
+    static ConnectionSnapshot *stale()
+    {
+        return reinterpret_cast<ConnectionSnapshot*>(static_cast<uintptr_t>(1));
+    }
+
+    void ref()
+    {
+        m_refs.fetch_add(1);
+    }
+
+    void deref()
+    {
+        if (m_refs.fetch_sub(1) == 1) {
+            const size_t size = allocationSize(m_count);
+            this->~ConnectionSnapshot();
+            CallbackAllocator::deallocate(this, size);
+        }
+    }
+
+    std::atomic<iint32>  m_refs;
+    SignalGuard  * const m_guard;
+    const size_t         m_count;
+    CallbackDummy       *m_callbacks[1]; ///< Actually m_count elements long
+
+private:
+    ConnectionSnapshot(const List<CallbackDummy*> &connections, SignalGuard *guard)
+        : m_refs(1)
+        , m_guard(guard)
+        , m_count(connections.size())
+    {
+        m_guard->ref();
+        CallbackDummy **callback = m_callbacks;
+        List<CallbackDummy*>::const_iterator it;
+        for (it = connections.begin(); it != connections.end(); ++it) {
+            *callback++ = *it;
+            (*it)->ref();
+        }
+    }
+
+    ~ConnectionSnapshot()
+    {
+        for (size_t i = 0; i < m_count; ++i) {
+            m_callbacks[i]->deref();
+        }
+        m_guard->deref();
+    }
+
+    static size_t allocationSize(size_t count)
+    {
+        return sizeof(ConnectionSnapshot) + (count ? count - 1 : 0) * sizeof(CallbackDummy*);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  *
+  * A call to a slot, together with a copy of the arguments the signal was emitted with, waiting
+  * to be run on the event loop of its receiver.
+  */
+class IDEAL_EXPORT QueuedCall
+{
+public:
+    QueuedCall(Object *receiver);
+    virtual ~QueuedCall();
+
+    /**
+      * Calls the slot, unless the receiver was destroyed or has blocked its signals since the call
+      * was queued.
+      */
+    void run();
+
+    std::atomic<QueuedCall*> m_next; ///< Link used by the queue this call is posted to
+
+protected:
+    virtual void call() = 0;
+
+    GeniousPointer<Object> m_receiver;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  */
+template <size_t... Index>
+struct IndexList
+{
+};
+
+/**
+  * @internal
+  */
+template <size_t Count, size_t... Index>
+struct MakeIndexList
+    : public MakeIndexList<Count - 1, Count - 1, Index...>
+{
+};
+
+/**
+  * @internal
+  */
+template <size_t... Index>
+struct MakeIndexList<0, Index...>
+{
+    typedef IndexList<Index...> Type;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  */
+template <typename Receiver, typename Member, typename... Param>
+class QueuedMemberCall
+    : public QueuedCall
+{
+public:
+    QueuedMemberCall(Receiver *receiver, Member member, const Param&... param)
+        : QueuedCall(receiver)
+        , m_member(member)
+        , m_param(param...)
+    {
+    }
+
+protected:
+    virtual void call()
+    {
+        call(typename MakeIndexList<sizeof...(Param)>::Type());
+    }
+
+private:
+    template <size_t... Index>
+    void call(IndexList<Index...>)
+    {
+        (static_cast<Receiver*>(m_receiver.content())->*m_member)(std::get<Index>(m_param)...);
+    }
+
+    Member                                          m_member;
+    std::tuple<typename std::decay<Param>::type...> m_param;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -57,18 +275,39 @@ class CallbackBase
     : public CallbackDummy
 {
 public:
+    CallbackBase()
+        : m_invoker(0)
+    {
+    }
+
     virtual ~CallbackBase()
     {
     }
 
     virtual void operator()(const Param&... param) = 0;
 
+    /**
+      * Calls this callback. Callbacks to a callable store a plain function with the callable
+      * inlined in m_invoker, so calling them does not go through the vtable.
+      */
+    void invoke(const Param&... param)
+    {
+        if (m_invoker) {
+            m_invoker(this, param...);
+            return;
+        }
+        (*this)(param...);
+    }
+
     template <typename Receiver, typename Member>
     static CallbackBase<Param...> *make(Receiver *receiver, Member member);
 
     template <typename Receiver, typename Member>
     static CallbackBase<Param...> *makeSynchronized(Receiver *receiver, Member member, Mutex &mutex);
 
+    template <typename Receiver, typename Member>
+    static CallbackBase<Param...> *makeQueued(Receiver *receiver, Member member);
+
     template <typename Receiver, typename Member>
     static CallbackBase<Param...> *makeMulti(SignalResource *resource, Receiver *receiver, Member member);
 
@@ -87,7 +326,18 @@ public:
     template <typename Member>
     static CallbackBase<Param...> *makeStaticMultiSynchronized(SignalResource *resource, Member member, Mutex &mutex);
 
+    template <typename Functor>
+    static CallbackBase<Param...> *makeFunctor(const Functor &functor);
+
+    template <typename Receiver, typename Functor>
+    static CallbackBase<Param...> *makeReceiverFunctor(Receiver *receiver, const Functor &functor);
+
     static CallbackBase<Param...> *makeForward(const SignalBase &signal);
+
+protected:
+    typedef void (*Invoker)(CallbackBase<Param...> *callback, const Param&... param);
+
+    Invoker m_invoker; ///< If not 0, called by invoke() instead of operator()
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -108,13 +358,9 @@ public:
 
     virtual void operator()(const Param&... param)
     {
-        Receiver *receiver = 0;
-        {
-            ContextMutexLocker cml(this->m_receiver->m_mutex);
-            if (static_cast<Receiver*>(this->m_receiver)->areSignalsBlocked()) {
-                return;
-            }
-            receiver = static_cast<Receiver*>(this->m_receiver);
+        Receiver *const receiver = static_cast<Receiver*>(this->m_receiver);
+        if (receiver->areSignalsBlocked()) {
+            return;
         }
         (receiver->*m_member)(param...);
     }
@@ -149,6 +395,28 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+  * @internal
+  */
+template <typename Receiver, typename Member, typename... Param>
+class CallbackQueued
+    : public Callback<Receiver, Member, Param...>
+{
+public:
+    CallbackQueued(Receiver *receiver, Member member)
+        : Callback<Receiver, Member, Param...>(receiver, member)
+    {
+    }
+
+    virtual void operator()(const Param&... param)
+    {
+        Receiver *const receiver = static_cast<Receiver*>(this->m_receiver);
+        receiver->postQueuedCall(new QueuedMemberCall<Receiver, Member, Param...>(receiver, this->m_member, param...));
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /**
   * @internal
   */
@@ -166,13 +434,9 @@ public:
 
     virtual void operator()(const Param&... param)
     {
-        Receiver *receiver = 0;
-        {
-            ContextMutexLocker cml(this->m_receiver->m_mutex);
-            if (static_cast<Receiver*>(this->m_receiver)->areSignalsBlocked()) {
-                return;
-            }
-            receiver = static_cast<Receiver*>(this->m_receiver);
+        Receiver *const receiver = static_cast<Receiver*>(this->m_receiver);
+        if (receiver->areSignalsBlocked()) {
+            return;
         }
         (receiver->*m_member)(m_sender, param...);
     }
@@ -308,6 +572,75 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+  * @internal
+  *
+  * Calls any callable object, like a lambda. The callable is stored inside the callback itself.
+  */
+template <typename Functor, typename... Param>
+class CallbackFunctor
+    : public CallbackBase<Param...>
+{
+public:
+    CallbackFunctor(const Functor &functor)
+        : m_functor(functor)
+    {
+        this->m_receiver = 0;
+        this->m_invoker = &CallbackFunctor::invoker;
+    }
+
+    virtual void operator()(const Param&... param)
+    {
+        m_functor(param...);
+    }
+
+    static void invoker(CallbackBase<Param...> *callback, const Param&... param)
+    {
+        static_cast<CallbackFunctor*>(callback)->m_functor(param...);
+    }
+
+    Functor m_functor;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  *
+  * Calls any callable object on behalf of @p receiver: it is not called if @p receiver has its
+  * signals blocked, and it is disconnected when @p receiver is destroyed.
+  */
+template <typename Receiver, typename Functor, typename... Param>
+class CallbackReceiverFunctor
+    : public CallbackBase<Param...>
+{
+public:
+    CallbackReceiverFunctor(Receiver *receiver, const Functor &functor)
+        : m_functor(functor)
+    {
+        this->m_receiver = receiver;
+        this->m_invoker = &CallbackReceiverFunctor::invoker;
+    }
+
+    virtual void operator()(const Param&... param)
+    {
+        invoker(this, param...);
+    }
+
+    static void invoker(CallbackBase<Param...> *callback, const Param&... param)
+    {
+        CallbackReceiverFunctor *const self = static_cast<CallbackReceiverFunctor*>(callback);
+        if (static_cast<Receiver*>(self->m_receiver)->areSignalsBlocked()) {
+            return;
+        }
+        self->m_functor(param...);
+    }
+
+    Functor m_functor;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /**
   * @internal
   */
@@ -332,6 +665,18 @@ CallbackBase<Param...> *CallbackBase<Param...>::makeSynchronized(Receiver *recei
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+  * @internal
+  */
+template <typename... Param>
+template <typename Receiver, typename Member>
+CallbackBase<Param...> *CallbackBase<Param...>::makeQueued(Receiver *receiver, Member member)
+{
+    return new CallbackQueued<Receiver, Member, Param...>(receiver, member);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /**
   * @internal
   */
@@ -404,6 +749,152 @@ CallbackBase<Param...> *CallbackBase<Param...>::makeStaticMultiSynchronized(Sign
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+  * @internal
+  */
+template <typename... Param>
+template <typename Functor>
+CallbackBase<Param...> *CallbackBase<Param...>::makeFunctor(const Functor &functor)
+{
+    return new CallbackFunctor<Functor, Param...>(functor);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  */
+template <typename... Param>
+template <typename Receiver, typename Functor>
+CallbackBase<Param...> *CallbackBase<Param...>::makeReceiverFunctor(Receiver *receiver, const Functor &functor)
+{
+    return new CallbackReceiverFunctor<Receiver, Functor, Param...>(receiver, functor);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  *
+  * An emission whose thread-safe callbacks are split in chunks between the emitting thread and
+  * helpers posted to the dispatcher pool of the application. run() does not return until every
+  * callback has finished.
+  */
+class IDEAL_EXPORT ParallelEmission
+{
+public:
+    virtual ~ParallelEmission();
+
+    /**
+      * Calls the callbacks in @p snapshot. Callbacks that were not connected as thread-safe are
+      * called from the calling thread, while the helpers work on the rest.
+      */
+    void run(SignalResource *parent, ConnectionSnapshot *snapshot);
+
+    /**
+      * Calls @p callback with the arguments of this emission.
+      */
+    virtual void call(CallbackDummy *callback) = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  * @internal
+  */
+template <typename... Param>
+class ParallelEmissionImpl
+    : public ParallelEmission
+{
+public:
+    ParallelEmissionImpl(const Param&... param)
+        : m_param(param...)
+    {
+    }
+
+    virtual void call(CallbackDummy *callback)
+    {
+        call(static_cast<CallbackBase<Param...>*>(callback), typename MakeIndexList<sizeof...(Param)>::Type());
+    }
+
+private:
+    template <size_t... Index>
+    void call(CallbackBase<Param...> *callbackBase, IndexList<Index...>)
+    {
+        callbackBase->invoke(std::get<Index>(m_param)...);
+    }
+
+    std::tuple<const Param&...> m_param;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef IDEAL_SIGNAL_PROFILING
+/**
+  * @internal
+  *
+  * Emission counters shared by all signals with the same name and signature. Profiles are never
+  * deleted, so signals keep a plain pointer to theirs.
+  *
+  * @see Application::signalStats
+  */
+class IDEAL_EXPORT SignalProfile
+{
+public:
+    /**
+      * @internal
+      *
+      * Accounts for one emission of @p profile when destroyed, and for the time spent calling
+      * slots since start() was called, if it was.
+      */
+    class IDEAL_EXPORT Emission
+    {
+    public:
+        Emission(SignalProfile *profile)
+            : m_profile(profile)
+            , m_slots(0)
+            , m_start(0)
+        {
+        }
+
+        ~Emission();
+
+        /**
+          * Starts measuring an emission that is going to call @p slots slots.
+          */
+        void start(size_t slots);
+
+    private:
+        SignalProfile *const m_profile;
+        size_t               m_slots;
+        iint64               m_start;
+    };
+
+    /**
+      * @return The profile of signals named @p name with signature @p signature, created if it
+      *         did not exist yet.
+      */
+    static SignalProfile *get(const ichar *name, const ichar *signature);
+
+    /**
+      * @return All profiles created so far.
+      */
+    static List<SignalProfile*> profiles();
+
+    const ichar *const   m_name;
+    const ichar *const   m_signature;
+    std::atomic<iuint64> m_emissions;
+    std::atomic<iuint64> m_slotCalls;
+    std::atomic<iuint64> m_maxSlots;
+    std::atomic<iuint64> m_slotTime;  ///< In nanoseconds
+
+private:
+    SignalProfile(const ichar *name, const ichar *signature);
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#endif
+
 /**
   * @internal
   */
@@ -416,71 +907,246 @@ public:
         : m_parent(parent)
         , m_isDestroyedSignal(true)
         , m_connectionsMutex(Mutex::Recursive)
-        , m_beingEmitted(false)
-        , m_beingEmittedMutex(Mutex::Recursive)
+        , m_snapshot(0)
+        , m_connectionsPruneSize(16)
+        , m_guard(0)
+        , m_emissionPolicy(Sequential)
+#ifdef IDEAL_SIGNAL_PROFILING
+        , m_profile(SignalProfile::get("destroyed", ""))
+#endif
     {
         parent->signalCreated(this);
     }
 
+#ifdef IDEAL_SIGNAL_PROFILING
+    SignalBase(SignalResource *parent, const ichar *name, const ichar *signature)
+#else
     SignalBase(SignalResource *parent, const ichar */* name */, const ichar */* signature */)
+#endif
         : m_parent(parent)
         , m_isDestroyedSignal(false)
         , m_connectionsMutex(Mutex::Recursive)
-        , m_beingEmitted(false)
-        , m_beingEmittedMutex(Mutex::Recursive)
+        , m_snapshot(0)
+        , m_connectionsPruneSize(16)
+        , m_guard(0)
+        , m_emissionPolicy(Sequential)
+#ifdef IDEAL_SIGNAL_PROFILING
+        , m_profile(SignalProfile::get(name, signature))
+#endif
     {
         parent->signalCreated(this);
     }
 
+    SignalBase(const SignalBase &signalBase)
+        : m_parent(signalBase.m_parent)
+        , m_isDestroyedSignal(signalBase.m_isDestroyedSignal)
+        , m_connectionsMutex(Mutex::Recursive)
+        , m_snapshot(0)
+        , m_connectionsPruneSize(16)
+        , m_guard(0)
+        , m_emissionPolicy(Sequential)
+#ifdef IDEAL_SIGNAL_PROFILING
+        , m_profile(signalBase.m_profile)
+#endif
+    {
+        m_parent->signalCreated(this);
+    }
+
     virtual ~SignalBase()
     {
-        ContextMutexLocker cml(m_beingEmittedMutex);
-        if (m_beingEmitted) {
-            ContextMutexLocker cml(deletedSignalsOnEmitMutex);
-            deletedSignalsOnEmit.push_back(this);
+        ContextMutexLocker cml(m_connectionsMutex);
+        if (m_guard) {
+            m_guard->m_destroyed.store(true);
+        }
+        releaseConnections();
+        if (m_guard) {
+            m_guard->deref();
         }
     }
 
+    enum EmissionPolicy {
+        Sequential = 0, ///< Slots are called one by one from the emitting thread
+        Parallel        ///< Slots connected as thread-safe are called from the dispatcher pool too
+    };
+
     SignalResource *parent() const
     {
         return m_parent;
     }
 
+    /**
+      * Sets how emit() calls the connected slots. With Parallel, the slots connected with
+      * connectThreadSafe() or connectStaticThreadSafe() are split in chunks and run at the same
+      * time on the emitting thread and on the dispatcher pool of the application, while the other
+      * slots are called one by one from the emitting thread. Either way, emit() returns when all
+      * slots have finished.
+      *
+      * This is worth it for signals with many independent receivers, as long as the slots do
+      * enough work to pay for waking up the helpers.
+      *
+      * @note Sequential by default.
+      */
+    void setEmissionPolicy(EmissionPolicy emissionPolicy) const
+    {
+        m_emissionPolicy.store(emissionPolicy, std::memory_order_relaxed);
+    }
+
+    EmissionPolicy emissionPolicy() const
+    {
+        return m_emissionPolicy.load(std::memory_order_relaxed);
+    }
+
     virtual void disconnect(SignalResource *receiver) const = 0;
 
     void disconnect() const
     {
-        List<CallbackDummy*>::iterator it;
         ContextMutexLocker cml(m_connectionsMutex);
-        for (it = m_connections.begin(); it != m_connections.end(); ++it) {
-            delete *it;
-        }
-        m_connections.clear();
+        releaseConnections();
     }
 
 protected:
-    static void notifyReceiverConnection(SignalResource *receiver, const SignalBase *signalBase)
+    /**
+      * Adds @p callback to the connections and lets @p receiver, if any, know about it.
+      */
+    Connection addConnection(SignalResource *receiver, CallbackDummy *callback, bool threadSafe = false) const
+    {
+        callback->m_threadSafe = threadSafe;
+        Connection connection(callback);
+        {
+            ContextMutexLocker cml(m_connectionsMutex);
+            m_connections.push_back(callback);
+            invalidateSnapshot();
+        }
+        if (receiver) {
+            receiver->signalConnected(this, connection);
+        }
+        return connection;
+    }
+
+    /**
+      * Marks the snapshot as out of date after a change to m_connections. Must be called with
+      * m_connectionsMutex locked. The new snapshot is built by the next emission, so connecting or
+      * disconnecting many slots in a row does not copy all connections every time.
+      */
+    void invalidateSnapshot() const
+    {
+        if (m_connections.size() >= m_connectionsPruneSize) {
+            pruneConnections();
+            m_connectionsPruneSize = std::max((size_t) 16, m_connections.size() * 2);
+        }
+        if (m_connections.empty()) {
+            updateSnapshot();
+            return;
+        }
+        publishSnapshot(ConnectionSnapshot::stale());
+    }
+
+    /**
+      * Publishes a new snapshot of m_connections right away. Must be called with
+      * m_connectionsMutex locked. Callbacks disconnected through their Connection handle are
+      * dropped.
+      */
+    void updateSnapshot() const
+    {
+        pruneConnections();
+        m_connectionsPruneSize = std::max((size_t) 16, m_connections.size() * 2);
+        ConnectionSnapshot *snapshot = 0;
+        if (!m_connections.empty()) {
+            if (!m_guard) {
+                m_guard = new SignalGuard;
+            }
+            snapshot = ConnectionSnapshot::create(m_connections, m_guard);
+        }
+        publishSnapshot(snapshot);
+    }
+
+    /**
+      * Drops the callbacks that were disconnected through their Connection handle from
+      * m_connections. Must be called with m_connectionsMutex locked.
+      */
+    void pruneConnections() const
     {
-        if (!signalBase->m_isDestroyedSignal) {
-            ContextMutexLocker cml(receiver->m_mutex);
-            receiver->signalConnected(signalBase);
+        List<CallbackDummy*>::iterator it = m_connections.begin();
+        while (it != m_connections.end()) {
+            CallbackDummy *const callback = *it;
+            if (callback->m_disconnected.load()) {
+                it = m_connections.erase(it);
+                callback->deref();
+                continue;
+            }
+            ++it;
         }
     }
 
-    static void notifyReceiverDisconnection(SignalResource *receiver, const SignalBase *signalBase)
+    /**
+      * Replaces the current snapshot with @p snapshot. Must be called with m_connectionsMutex
+      * locked.
+      */
+    void publishSnapshot(ConnectionSnapshot *snapshot) const
     {
-        if (!signalBase->m_isDestroyedSignal) {
-            ContextMutexLocker cml(receiver->m_mutex);
-            receiver->signalDisconnected(signalBase);
+        ConnectionSnapshot *const oldSnapshot = m_snapshot.exchange(snapshot);
+        if (oldSnapshot && oldSnapshot != ConnectionSnapshot::stale()) {
+            ConnectionSnapshot::retire(oldSnapshot);
         }
     }
 
-    SignalResource       * const m_parent;
-    const bool                   m_isDestroyedSignal;
-    mutable List<CallbackDummy*> m_connections;
-    mutable Mutex                m_connectionsMutex;
-    mutable bool                 m_beingEmitted;
-    mutable Mutex                m_beingEmittedMutex;
+    /**
+      * @return A reference to the current snapshot, or 0 if there are no connections. The caller
+      *         has to deref() it when done.
+      */
+    ConnectionSnapshot *acquireSnapshot() const
+    {
+        ConnectionSnapshot *snapshot = ConnectionSnapshot::acquire(m_snapshot);
+        if (snapshot != ConnectionSnapshot::stale()) {
+            return snapshot;
+        }
+        // The first emission after a change builds the new snapshot. Nobody can replace it while
+        // m_connectionsMutex is locked
+        ContextMutexLocker cml(m_connectionsMutex);
+        if (m_snapshot.load() == ConnectionSnapshot::stale()) {
+            updateSnapshot();
+        }
+        snapshot = m_snapshot.load();
+        if (snapshot) {
+            snapshot->ref();
+        }
+        return snapshot;
+    }
+
+    /**
+      * Drops the connection reference of @p callback, once it has been removed from m_connections.
+      * Emissions still holding an older snapshot will skip it.
+      */
+    static void releaseCallback(CallbackDummy *callback)
+    {
+        callback->m_disconnected.store(true);
+        callback->deref();
+    }
+
+    /**
+      * Removes all connections. Must be called with m_connectionsMutex locked.
+      */
+    void releaseConnections() const
+    {
+        List<CallbackDummy*>::iterator it;
+        for (it = m_connections.begin(); it != m_connections.end(); ++it) {
+            releaseCallback(*it);
+        }
+        m_connections.clear();
+        updateSnapshot();
+    }
+
+    SignalResource                      * const m_parent;
+    const bool                                  m_isDestroyedSignal;
+    mutable List<CallbackDummy*>                m_connections;
+    mutable Mutex                               m_connectionsMutex;
+    mutable std::atomic<ConnectionSnapshot*>    m_snapshot;
+    mutable size_t                              m_connectionsPruneSize; ///< When to drop disconnected callbacks from m_connections
+    mutable SignalGuard                        *m_guard;
+    mutable std::atomic<EmissionPolicy>         m_emissionPolicy;
+#ifdef IDEAL_SIGNAL_PROFILING
+    SignalProfile                       * const m_profile;
+#endif
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -506,120 +1172,165 @@ public:
 
     virtual ~Signal()
     {
-        List<CallbackDummy*>::iterator it;
-        ContextMutexLocker cml(m_connectionsMutex);
-        for (it = m_connections.begin(); it != m_connections.end(); ++it) {
-            delete *it;
-        }
-        m_connections.clear();
     }
 
     virtual void disconnect(SignalResource *receiver) const
     {
+        bool disconnected = false;
         List<CallbackDummy*>::iterator it;
         ContextMutexLocker cml(m_connectionsMutex);
         for (it = m_connections.begin(); it != m_connections.end();) {
-            const CallbackDummy *const curr = *it;
-            if (curr->m_receiver == static_cast<void*>(receiver)) {
-                notifyReceiverDisconnection(receiver, this);
+            CallbackDummy *const curr = *it;
+            if (!curr->m_disconnected.load() && curr->m_receiver == static_cast<void*>(receiver)) {
                 it = m_connections.erase(it);
-                delete curr;
+                releaseCallback(curr);
+                disconnected = true;
                 continue;
             }
             ++it;
         }
+        if (disconnected) {
+            invalidateSnapshot();
+        }
     }
 
     template <typename Receiver, typename Member>
-    void connect(Receiver *receiver, Member member) const
+    typename std::enable_if<std::is_member_function_pointer<Member>::value, Connection>::type connect(Receiver *receiver, Member member) const
     {
         if (!receiver) {
             IDEAL_DEBUG_WARNING("connection failed. NULL receiver");
-            return;
+            return Connection();
         }
-        notifyReceiverConnection(receiver, this);
-        CallbackBase<Param...> *callback = CallbackBase<Param...>::make(receiver, member);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(callback);
+        return addConnection(receiver, CallbackBase<Param...>::make(receiver, member));
+    }
+
+    /**
+      * Connects this signal to @p functor, that can be any callable object (e.g. a lambda)
+      * accepting the parameters of this signal. @p functor is not called while @p receiver has its
+      * signals blocked, and it is disconnected when @p receiver is destroyed.
+      */
+    template <typename Receiver, typename Functor>
+    typename std::enable_if<!std::is_member_function_pointer<Functor>::value, Connection>::type connect(Receiver *receiver, Functor functor) const
+    {
+        if (!receiver) {
+            IDEAL_DEBUG_WARNING("connection failed. NULL receiver");
+            return Connection();
+        }
+        return addConnection(receiver, CallbackBase<Param...>::makeReceiverFunctor(receiver, functor));
+    }
+
+    /**
+      * Connects this signal to @p functor, that can be any callable object (e.g. a lambda)
+      * accepting the parameters of this signal. It stays connected until disconnected through the
+      * returned handle, or until this signal is destroyed.
+      */
+    template <typename Functor>
+    Connection connect(Functor functor) const
+    {
+        return addConnection(0, CallbackBase<Param...>::makeFunctor(functor));
     }
 
+    /**
+      * Connects this signal to @p member in @p receiver, declaring that @p member can be called
+      * from any thread, at the same time as other slots. When the emission policy is Parallel,
+      * it will be called from the dispatcher pool.
+      *
+      * @see setEmissionPolicy
+      */
     template <typename Receiver, typename Member>
-    void connectSynchronized(Receiver *receiver, Member member, Mutex &mutex) const
+    Connection connectThreadSafe(Receiver *receiver, Member member) const
     {
         if (!receiver) {
             IDEAL_DEBUG_WARNING("connection failed. NULL receiver");
-            return;
+            return Connection();
         }
-        notifyReceiverConnection(receiver, this);
-        CallbackBase<Param...> *callback = CallbackBase<Param...>::makeSynchronized(receiver, member, mutex);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(callback);
+        return addConnection(receiver, CallbackBase<Param...>::make(receiver, member), true);
     }
 
     template <typename Receiver, typename Member>
-    void connectMulti(Receiver *receiver, Member member) const
+    Connection connectSynchronized(Receiver *receiver, Member member, Mutex &mutex) const
     {
         if (!receiver) {
             IDEAL_DEBUG_WARNING("connection failed. NULL receiver");
-            return;
+            return Connection();
         }
-        notifyReceiverConnection(receiver, this);
-        CallbackBase<Param...> *callback = CallbackBase<Param...>::makeMulti(m_parent, receiver, member);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(callback);
+        return addConnection(receiver, CallbackBase<Param...>::makeSynchronized(receiver, member, mutex));
     }
 
+    /**
+      * Connects this signal to @p member in @p receiver. When emitted, the arguments are copied
+      * and @p member is called later from the event loop @p receiver belongs to, instead of from
+      * the emitting thread. The emitting thread never waits for the receiver.
+      */
     template <typename Receiver, typename Member>
-    void connectMultiSynchronized(Receiver *receiver, Member member, Mutex &mutex) const
+    Connection connectQueued(Receiver *receiver, Member member) const
     {
         if (!receiver) {
             IDEAL_DEBUG_WARNING("connection failed. NULL receiver");
-            return;
+            return Connection();
         }
-        notifyReceiverConnection(receiver, this);
-        CallbackBase<Param...> *callback = CallbackBase<Param...>::makeMultiSynchronized(m_parent, receiver, member, mutex);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(callback);
+        return addConnection(receiver, CallbackBase<Param...>::makeQueued(receiver, member));
     }
 
-    void connect(const Signal<Param...> &signal) const
+    template <typename Receiver, typename Member>
+    Connection connectMulti(Receiver *receiver, Member member) const
     {
-        notifyReceiverConnection(signal.parent(), this);
-        CallbackBase<Param...> *signalForward = CallbackBase<Param...>::makeForward(signal);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(signalForward);
+        if (!receiver) {
+            IDEAL_DEBUG_WARNING("connection failed. NULL receiver");
+            return Connection();
+        }
+        return addConnection(receiver, CallbackBase<Param...>::makeMulti(m_parent, receiver, member));
+    }
+
+    template <typename Receiver, typename Member>
+    Connection connectMultiSynchronized(Receiver *receiver, Member member, Mutex &mutex) const
+    {
+        if (!receiver) {
+            IDEAL_DEBUG_WARNING("connection failed. NULL receiver");
+            return Connection();
+        }
+        return addConnection(receiver, CallbackBase<Param...>::makeMultiSynchronized(m_parent, receiver, member, mutex));
+    }
+
+    Connection connect(const Signal<Param...> &signal) const
+    {
+        return addConnection(signal.parent(), CallbackBase<Param...>::makeForward(signal));
     }
 
     template <typename Member>
-    void connectStatic(Member member) const
+    Connection connectStatic(Member member) const
     {
-        CallbackBase<Param...> *callback = CallbackBase<Param...>::makeStatic(member);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(callback);
+        return addConnection(0, CallbackBase<Param...>::makeStatic(member));
     }
 
+    /**
+      * Connects this signal to the static @p member, declaring that it can be called from any
+      * thread, at the same time as other slots.
+      *
+      * @see connectThreadSafe
+      */
     template <typename Member>
-    void connectStaticSynchronized(Member member, Mutex &mutex) const
+    Connection connectStaticThreadSafe(Member member) const
     {
-        CallbackBase<Param...> *callback = CallbackBase<Param...>::makeStaticSynchronized(member, mutex);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(callback);
+        return addConnection(0, CallbackBase<Param...>::makeStatic(member), true);
     }
 
     template <typename Member>
-    void connectStaticMulti(Member member) const
+    Connection connectStaticSynchronized(Member member, Mutex &mutex) const
     {
-        CallbackBase<Param...> *callback = CallbackBase<Param...>::makeStaticMulti(m_parent, member);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(callback);
+        return addConnection(0, CallbackBase<Param...>::makeStaticSynchronized(member, mutex));
     }
 
     template <typename Member>
-    void connectStaticMultiSynchronized(Member member, Mutex &mutex) const
+    Connection connectStaticMulti(Member member) const
     {
-        CallbackBase<Param...> *callback = CallbackBase<Param...>::makeStaticMultiSynchronized(m_parent, member, mutex);
-        ContextMutexLocker cml(m_connectionsMutex);
-        m_connections.push_back(callback);
+        return addConnection(0, CallbackBase<Param...>::makeStaticMulti(m_parent, member));
+    }
+
+    template <typename Member>
+    Connection connectStaticMultiSynchronized(Member member, Mutex &mutex) const
+    {
+        return addConnection(0, CallbackBase<Param...>::makeStaticMultiSynchronized(m_parent, member, mutex));
     }
 
     template <typename Receiver, typename Member>
@@ -629,14 +1340,14 @@ public:
             IDEAL_DEBUG_WARNING("disconnection failed. NULL receiver");
             return;
         }
-        notifyReceiverDisconnection(receiver, this);
         List<CallbackDummy*>::iterator it;
         ContextMutexLocker cml(m_connectionsMutex);
         for (it = m_connections.begin(); it != m_connections.end(); ++it) {
             Callback<Receiver, Member, Param...> *const curr = dynamic_cast<Callback<Receiver, Member, Param...>*>(*it);
-            if (curr && curr->m_receiver == static_cast<void*>(receiver) && curr->m_member == member) {
+            if (curr && !curr->m_disconnected.load() && curr->m_receiver == static_cast<void*>(receiver) && curr->m_member == member) {
                 m_connections.erase(it);
-                delete curr;
+                invalidateSnapshot();
+                releaseCallback(curr);
                 return;
             }
         }
@@ -650,20 +1361,41 @@ public:
             IDEAL_DEBUG_WARNING("disconnection failed. NULL receiver");
             return;
         }
-        notifyReceiverDisconnection(receiver, this);
         List<CallbackDummy*>::iterator it;
         ContextMutexLocker cml(m_connectionsMutex);
         for (it = m_connections.begin(); it != m_connections.end(); ++it) {
             CallbackSynchronized<Receiver, Member, Param...> *const curr = dynamic_cast<CallbackSynchronized<Receiver, Member, Param...>*>(*it);
-            if (curr && curr->m_receiver == static_cast<void*>(receiver) && curr->m_member == member && curr->m_mutex == mutex) {
+            if (curr && !curr->m_disconnected.load() && curr->m_receiver == static_cast<void*>(receiver) && curr->m_member == member && curr->m_mutex == mutex) {
                 m_connections.erase(it);
-                delete curr;
+                invalidateSnapshot();
+                releaseCallback(curr);
                 return;
             }
         }
         IDEAL_SDEBUG("no synchronized slot disconnected. No previous connection found.");
     }
 
+    template <typename Receiver, typename Member>
+    void disconnectQueued(Receiver *receiver, Member member) const
+    {
+        if (!receiver) {
+            IDEAL_DEBUG_WARNING("disconnection failed. NULL receiver");
+            return;
+        }
+        List<CallbackDummy*>::iterator it;
+        ContextMutexLocker cml(m_connectionsMutex);
+        for (it = m_connections.begin(); it != m_connections.end(); ++it) {
+            CallbackQueued<Receiver, Member, Param...> *const curr = dynamic_cast<CallbackQueued<Receiver, Member, Param...>*>(*it);
+            if (curr && !curr->m_disconnected.load() && curr->m_receiver == static_cast<void*>(receiver) && curr->m_member == member) {
+                m_connections.erase(it);
+                invalidateSnapshot();
+                releaseCallback(curr);
+                return;
+            }
+        }
+        IDEAL_SDEBUG("no queued slot disconnected. No previous connection found.");
+    }
+
     template <typename Receiver, typename Member>
     void disconnectMulti(Receiver *receiver, Member member) const
     {
@@ -671,14 +1403,14 @@ public:
             IDEAL_DEBUG_WARNING("disconnection failed. NULL receiver");
             return;
         }
-        notifyReceiverDisconnection(receiver, this);
         List<CallbackDummy*>::iterator it;
         ContextMutexLocker cml(m_connectionsMutex);
         for (it = m_connections.begin(); it != m_connections.end(); ++it) {
             CallbackMulti<Receiver, Member, Param...> *const curr = dynamic_cast<CallbackMulti<Receiver, Member, Param...>*>(*it);
-            if (curr && curr->m_receiver == static_cast<void*>(receiver) && curr->m_member == member) {
+            if (curr && !curr->m_disconnected.load() && curr->m_receiver == static_cast<void*>(receiver) && curr->m_member == member) {
                 m_connections.erase(it);
-                delete curr;
+                invalidateSnapshot();
+                releaseCallback(curr);
                 return;
             }
         }
@@ -692,14 +1424,14 @@ public:
             IDEAL_DEBUG_WARNING("disconnection failed. NULL receiver");
             return;
         }
-        notifyReceiverDisconnection(receiver, this);
         List<CallbackDummy*>::iterator it;
         ContextMutexLocker cml(m_connectionsMutex);
         for (it = m_connections.begin(); it != m_connections.end(); ++it) {
             CallbackMultiSynchronized<Receiver, Member, Param...> *const curr = dynamic_cast<CallbackMultiSynchronized<Receiver, Member, Param...>*>(*it);
-            if (curr && curr->m_receiver == static_cast<void*>(receiver) && curr->m_member == member && curr->m_mutex == mutex) {
+            if (curr && !curr->m_disconnected.load() && curr->m_receiver == static_cast<void*>(receiver) && curr->m_member == member && curr->m_mutex == mutex) {
                 m_connections.erase(it);
-                delete curr;
+                invalidateSnapshot();
+                releaseCallback(curr);
                 return;
             }
         }
@@ -715,9 +1447,10 @@ public:
         ContextMutexLocker cml(m_connectionsMutex);
         for (it = m_connections.begin(); it != m_connections.end(); ++it) {
             CallbackStatic<Member, Param...> *const curr = dynamic_cast<CallbackStatic<Member, Param...>*>(*it);
-            if (curr && curr->m_member == member) {
+            if (curr && !curr->m_disconnected.load() && curr->m_member == member) {
                 m_connections.erase(it);
-                delete curr;
+                invalidateSnapshot();
+                releaseCallback(curr);
                 return;
             }
         }
@@ -731,9 +1464,10 @@ public:
         ContextMutexLocker cml(m_connectionsMutex);
         for (it = m_connections.begin(); it != m_connections.end(); ++it) {
             CallbackStaticSynchronized<Member, Param...> *const curr = dynamic_cast<CallbackStaticSynchronized<Member, Param...>*>(*it);
-            if (curr && curr->m_member == member && curr->m_mutex == mutex) {
+            if (curr && !curr->m_disconnected.load() && curr->m_member == member && curr->m_mutex == mutex) {
                 m_connections.erase(it);
-                delete curr;
+                invalidateSnapshot();
+                releaseCallback(curr);
                 return;
             }
         }
@@ -747,9 +1481,10 @@ public:
         ContextMutexLocker cml(m_connectionsMutex);
         for (it = m_connections.begin(); it != m_connections.end(); ++it) {
             CallbackStaticMulti<Member, Param...> *const curr = dynamic_cast<CallbackStaticMulti<Member, Param...>*>(*it);
-            if (curr && curr->m_member == member) {
+            if (curr && !curr->m_disconnected.load() && curr->m_member == member) {
                 m_connections.erase(it);
-                delete curr;
+                invalidateSnapshot();
+                releaseCallback(curr);
                 return;
             }
         }
@@ -763,9 +1498,10 @@ public:
         ContextMutexLocker cml(m_connectionsMutex);
         for (it = m_connections.begin(); it != m_connections.end(); ++it) {
             CallbackStaticMultiSynchronized<Member, Param...> *const curr = dynamic_cast<CallbackStaticMultiSynchronized<Member, Param...>*>(*it);
-            if (curr && curr->m_member == member && curr->m_mutex == mutex) {
+            if (curr && !curr->m_disconnected.load() && curr->m_member == member && curr->m_mutex == mutex) {
                 m_connections.erase(it);
-                delete curr;
+                invalidateSnapshot();
+                releaseCallback(curr);
                 return;
             }
         }
@@ -774,34 +1510,57 @@ public:
 
     void emit(const Param&... param) const
     {
+#ifdef IDEAL_SIGNAL_PROFILING
+        SignalProfile::Emission profiledEmission(m_profile);
+#endif
+        if (!m_snapshot.load()) {
+            return;
+        }
         if (m_parent->isEmitBlocked() && !m_isDestroyedSignal) {
             return;
         }
-        {
-            ContextMutexLocker cml(m_beingEmittedMutex);
-            m_beingEmitted = true;
+        ConnectionSnapshot *const snapshot = acquireSnapshot();
+        if (!snapshot) {
+            return;
         }
-        List<CallbackDummy*> connections;
-        {
-            ContextMutexLocker cml(m_connectionsMutex);
-            connections = m_connections;
+#ifdef IDEAL_SIGNAL_PROFILING
+        profiledEmission.start(snapshot->m_count);
+#endif
+        // A single connection needs no bookkeeping: nothing is touched after calling it
+        if (snapshot->m_count == 1 && !snapshot->m_callbacks[0]->m_disconnected.load()) {
+            static_cast<CallbackBase<Param...>*>(snapshot->m_callbacks[0])->invoke(param...);
+            snapshot->deref();
+            return;
         }
-        List<CallbackDummy*>::const_iterator it;
-        for (it = connections.begin(); it != connections.end(); ++it) {
-            CallbackBase<Param...> *callbackBase = static_cast<CallbackBase<Param...>*>(*it);
-            (*callbackBase)(param...);
-            List<SignalBase*>::iterator it;
-            ContextMutexLocker cml(deletedSignalsOnEmitMutex);
-            for (it = deletedSignalsOnEmit.begin(); it != deletedSignalsOnEmit.end(); ++it) {
-                if (*it == this) {
-                    deletedSignalsOnEmit.erase(it);
-                    return;
-                }
+        if (m_emissionPolicy.load(std::memory_order_relaxed) == Parallel) {
+            ParallelEmissionImpl<Param...> parallelEmission(param...);
+            parallelEmission.run(m_parent, snapshot);
+            snapshot->deref();
+            return;
+        }
+        // The snapshot keeps the guard alive, so we can tell whether a slot destroyed this signal
+        // without touching it
+        const SignalGuard *const guard = snapshot->m_guard;
+        bool foundDisconnected = false;
+        for (size_t i = 0; i < snapshot->m_count; ++i) {
+            CallbackDummy *const callback = snapshot->m_callbacks[i];
+            if (callback->m_disconnected.load()) {
+                foundDisconnected = true;
+                continue;
+            }
+            CallbackBase<Param...> *callbackBase = static_cast<CallbackBase<Param...>*>(callback);
+            callbackBase->invoke(param...);
+            if (guard->m_destroyed.load()) {
+                snapshot->deref();
+                return;
             }
         }
-        {
-            ContextMutexLocker cml(m_beingEmittedMutex);
-            m_beingEmitted = false;
+        snapshot->deref();
+        // Callbacks disconnected through their handle are dropped here, if nobody else is changing
+        // the connections at the moment; otherwise, whoever is doing it will drop them
+        if (foundDisconnected && m_connectionsMutex.tryLock()) {
+            updateSnapshot();
+            m_connectionsMutex.unlock();
         }
     }
 
@@ -856,14 +1615,14 @@ CallbackBase<Param...> *CallbackBase<Param...>::makeForward(const SignalBase &si
 template <typename... Param>
 void Signal<Param...>::disconnect(const Signal<Param...> &signal) const
 {
-    notifyReceiverDisconnection(signal.parent(), this);
     List<CallbackDummy*>::iterator it;
     ContextMutexLocker cml(m_connectionsMutex);
     for (it = m_connections.begin(); it != m_connections.end(); ++it) {
         SignalCallback<Param...> *const curr = dynamic_cast<SignalCallback<Param...>*>(*it);
-        if (curr && curr->m_signal == &signal) {
+        if (curr && !curr->m_disconnected.load() && curr->m_signal == &signal) {
             m_connections.erase(it);
-            delete curr;
+            invalidateSnapshot();
+            releaseCallback(curr);
             return;
         }
     }
@@ -19,6 +19,7 @@
  */
 
 #include "ideal_string.h"
+#include "ref_count.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -47,18 +48,22 @@ public:
     void iuint64toa(iuint64 number, iuint32 base, bool negative = false);
     void dtoa(double number, iuint8 format, iuint32 precision);
 
+    /**
+      * @return The data all empty strings point to. The reference it was created with is never
+      *         released, so it is never deleted, and it is always copied before being modified.
+      */
+    static Private *sharedEmpty();
     static Private *empty();
 
-    ichar  *m_str;
-    size_t *m_charMap;
-    size_t  m_size;
-    bool    m_sizeCalculated;
-    size_t  m_rawLen;
-    bool    m_rawLenCalculated;
-    size_t  m_refs;
+    ichar    *m_str;
+    size_t   *m_charMap;
+    size_t    m_size;
+    bool      m_sizeCalculated;
+    size_t    m_rawLen;
+    bool      m_rawLenCalculated;
+    RefCount  m_refs;
 
     class PrivateEmpty;
-    static Private *m_privateEmpty;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -105,21 +110,17 @@ String::Private *String::Private::copy()
 
 void String::Private::copyAndDetach(String *str)
 {
-    if (m_refs > 1) {
+    if (m_refs.isShared()) {
         str->d = copy();
         deref();
-    } else if (this == m_privateEmpty) {
-        m_privateEmpty = 0;
     }
 }
 
 void String::Private::newAndDetach(String *str)
 {
-    if (m_refs > 1) {
+    if (m_refs.isShared()) {
         str->d = new Private;
         deref();
-    } else if (this == m_privateEmpty) {
-        m_privateEmpty = 0;
     } else {
         clearContents();
     }
@@ -139,16 +140,12 @@ void String::Private::clearContents()
 
 void String::Private::ref()
 {
-    ++m_refs;
+    m_refs.ref();
 }
 
 void String::Private::deref()
 {
-    --m_refs;
-    if (!m_refs) {
-        if (this == m_privateEmpty) {
-            m_privateEmpty = 0;
-        }
+    if (m_refs.deref()) {
         delete this;
     }
 }
@@ -269,8 +266,6 @@ void String::Private::dtoa(double number, iuint8 format, iuint32 precision)
     free(res);
 }
 
-String::Private *String::Private::m_privateEmpty = 0;
-
 class String::Private::PrivateEmpty
     : public Private
 {
@@ -289,14 +284,17 @@ public:
     }
 };
 
+String::Private *String::Private::sharedEmpty()
+{
+    static Private *const privateEmpty = new PrivateEmpty;
+    return privateEmpty;
+}
+
 String::Private *String::Private::empty()
 {
-    if (!m_privateEmpty) {
-        m_privateEmpty = new PrivateEmpty;
-    } else {
-        m_privateEmpty->ref();
-    }
-    return m_privateEmpty;
+    Private *const res = sharedEmpty();
+    res->ref();
+    return res;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -392,7 +390,7 @@ String::~String()
 
 void String::clear()
 {
-    if (d == Private::m_privateEmpty) {
+    if (d == Private::sharedEmpty()) {
         return;
     }
     d->deref();
@@ -401,7 +399,7 @@ void String::clear()
 
 bool String::empty() const
 {
-    return d == Private::m_privateEmpty || d->calculateSize() == 0;
+    return d == Private::sharedEmpty() || d->calculateSize() == 0;
 }
 
 size_t String::size() const
@@ -42,8 +42,11 @@ Module::Private::~Private()
     if (m_unused) {
         FakeModule *fakeModule = new FakeModule;
         fakeModule->d->m_handle = m_handle;
-        ContextMutexLocker cml(m_application->d->m_markedForUnloadMutex);
-        m_application->d->m_markedForUnload.push_back(fakeModule);
+        {
+            ContextMutexLocker cml(m_application->d->m_markedForUnloadMutex);
+            m_application->d->m_markedForUnload.push_back(fakeModule);
+        }
+        m_application->d->m_eventLoop.wakeUp();
     }
 }
 
@@ -58,6 +61,7 @@ void Module::Private::deref()
     }
     if (!--m_refs) {
         m_application->d->m_markedForUnload.push_back(q);
+        m_application->d->m_eventLoop.wakeUp();
     }
 }
 
@@ -19,53 +19,132 @@
  */
 
 #include "mutex.h"
-#include "private/mutex_p.h"
+#include "private/futex_p.h"
+
+#include <algorithm>
+
+#ifdef IDEAL_MUTEX_PROFILING
+#include <core/context_mutex_locker.h>
+
+#include <map>
+#include <sstream>
+#include <string>
+
+#include <time.h>
+#endif
+
+#include <unistd.h>
 
 namespace IdealCore {
 
-Mutex::Private::Private()
-    : m_refs(1)
+namespace {
+
+enum {
+    MaxSpins = 100
+};
+
+thread_local ichar threadMarker;
+
+/**
+  * @return Something that identifies the calling thread, and is cheaper than asking the system.
+  */
+inline const void *currentThread()
 {
+    return &threadMarker;
 }
 
-Mutex::Private::~Private()
+/**
+  * @return Whether spinning can be of any help. With a single processor, the thread holding the
+  *         mutex cannot make any progress while we spin.
+  */
+bool spinningHelps()
 {
+    static const bool res = sysconf(_SC_NPROCESSORS_ONLN) > 1;
+    return res;
 }
 
-void Mutex::Private::ref()
+inline void cpuRelax()
 {
-    ++m_refs;
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#endif
 }
 
-void Mutex::Private::deref()
+#ifdef IDEAL_MUTEX_PROFILING
+/**
+  * @return The same as Timer::monotonicTime(). Timer cannot be used from here, since it is built on
+  *         top of Object, which already uses Mutex.
+  */
+iint64 monotonicTime()
 {
-    --m_refs;
-    if (!m_refs) {
-        delete this;
-    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (iint64) ts.tv_sec * 1000000000LL + ts.tv_nsec;
 }
+#endif
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
+}
 
-Mutex::Mutex(RecursionType recursionType)
-    : d(new PrivateImpl(recursionType))
+#ifdef IDEAL_MUTEX_PROFILING
+Mutex::Mutex(RecursionType recursionType, const ichar *file, iint32 line)
+    : m_state(Unlocked)
+    , m_recursionType(recursionType)
+    , m_spins(0)
+    , m_owner(0)
+    , m_recursion(0)
+    , m_profile(MutexProfile::get(file, line))
+    , m_lockedAt(0)
 {
 }
 
-Mutex::Mutex(const Mutex &mutex)
+Mutex::Mutex(RecursionType recursionType, MutexProfile *profile)
+    : m_state(Unlocked)
+    , m_recursionType(recursionType)
+    , m_spins(0)
+    , m_owner(0)
+    , m_recursion(0)
+    , m_profile(profile)
+    , m_lockedAt(0)
 {
-    mutex.d->ref();
-    d = mutex.d;
 }
+#else
+Mutex::Mutex(RecursionType recursionType)
+    : m_state(Unlocked)
+    , m_recursionType(recursionType)
+    , m_spins(0)
+    , m_owner(0)
+    , m_recursion(0)
+{
+}
+#endif
 
 Mutex::~Mutex()
 {
-    d->deref();
+}
+
+bool Mutex::tryLock()
+{
+    if (m_recursionType == Recursive && m_owner.load(std::memory_order_relaxed) == currentThread()) {
+        ++m_recursion;
+        return true;
+    }
+    iint32 unlocked = Unlocked;
+    if (!m_state.compare_exchange_strong(unlocked, Locked, std::memory_order_acquire)) {
+        return false;
+    }
+    if (m_recursionType == Recursive) {
+        m_owner.store(currentThread(), std::memory_order_relaxed);
+        m_recursion = 1;
+    }
+#ifdef IDEAL_MUTEX_PROFILING
+    profileAcquired(0);
+#endif
+    return true;
 }
 
 bool Mutex::operator==(const Mutex &mutex) const
 {
-    return (d == mutex.d);
+    return this == &mutex;
 }
 
 bool Mutex::operator!=(const Mutex &mutex) const
@@ -73,4 +152,194 @@ bool Mutex::operator!=(const Mutex &mutex) const
     return !(*this == mutex);
 }
 
+void Mutex::lockSlow()
+{
+    if (m_recursionType == Recursive) {
+        // Only this thread can have stored itself as the owner, so a relaxed load is enough
+        if (m_owner.load(std::memory_order_relaxed) == currentThread()) {
+            ++m_recursion;
+            return;
+        }
+        iint32 unlocked = Unlocked;
+        if (m_state.compare_exchange_strong(unlocked, Locked, std::memory_order_acquire)) {
+            m_owner.store(currentThread(), std::memory_order_relaxed);
+            m_recursion = 1;
+#ifdef IDEAL_MUTEX_PROFILING
+            profileAcquired(0);
+#endif
+            return;
+        }
+    }
+#ifdef IDEAL_MUTEX_PROFILING
+    const iint64 waitStart = monotonicTime();
+#endif
+    lockState();
+    if (m_recursionType == Recursive) {
+        m_owner.store(currentThread(), std::memory_order_relaxed);
+        m_recursion = 1;
+    }
+#ifdef IDEAL_MUTEX_PROFILING
+    profileAcquired(waitStart);
+#endif
+}
+
+void Mutex::lockState()
+{
+    if (spinningHelps()) {
+        const iint32 spins = m_spins.load(std::memory_order_relaxed);
+        const iint32 maxSpins = std::min((iint32) MaxSpins, spins * 2 + 10);
+        for (iint32 i = 0; i < maxSpins; ++i) {
+            iint32 unlocked = Unlocked;
+            if (m_state.load(std::memory_order_relaxed) == Unlocked &&
+                m_state.compare_exchange_weak(unlocked, Locked, std::memory_order_acquire)) {
+                m_spins.store(spins + (i - spins) / 8, std::memory_order_relaxed);
+                return;
+            }
+            cpuRelax();
+        }
+        m_spins.store(spins + (maxSpins - spins) / 8, std::memory_order_relaxed);
+    }
+    lockContended();
+}
+
+void Mutex::lockContended()
+{
+    // We cannot tell whether there are other sleepers, so we lock it as LockedWithWaiters and
+    // unlock() will wake up somebody, just in case
+    while (m_state.exchange(LockedWithWaiters, std::memory_order_acquire) != Unlocked) {
+        Futex::wait(m_state, LockedWithWaiters);
+    }
+}
+
+void Mutex::unlockRecursive()
+{
+    if (--m_recursion) {
+        return;
+    }
+#ifdef IDEAL_MUTEX_PROFILING
+    profileReleased();
+#endif
+    m_owner.store(0, std::memory_order_relaxed);
+    if (m_state.exchange(Unlocked, std::memory_order_release) == LockedWithWaiters) {
+        wakeOne();
+    }
+}
+
+void Mutex::wakeOne()
+{
+    Futex::wake(m_state, 1);
+}
+
+iint32 Mutex::release()
+{
+    const iint32 recursion = m_recursion;
+#ifdef IDEAL_MUTEX_PROFILING
+    profileReleased();
+#endif
+    if (m_recursionType == Recursive) {
+        m_owner.store(0, std::memory_order_relaxed);
+        m_recursion = 0;
+    }
+    if (m_state.exchange(Unlocked, std::memory_order_release) == LockedWithWaiters) {
+        wakeOne();
+    }
+    return recursion;
+}
+
+void Mutex::reacquire(iint32 recursion)
+{
+    lockContended();
+    if (m_recursionType == Recursive) {
+        m_owner.store(currentThread(), std::memory_order_relaxed);
+        m_recursion = recursion;
+    }
+#ifdef IDEAL_MUTEX_PROFILING
+    // Waking up from a condition variable is not contention on the mutex
+    profileAcquired(0);
+#endif
+}
+
+#ifdef IDEAL_MUTEX_PROFILING
+void Mutex::profileAcquired(iint64 waitStart)
+{
+    if (!m_profile) {
+        return;
+    }
+    m_lockedAt = monotonicTime();
+    m_profile->m_acquisitions.fetch_add(1, std::memory_order_relaxed);
+    if (waitStart) {
+        m_profile->m_contentions.fetch_add(1, std::memory_order_relaxed);
+        m_profile->m_waitTime.fetch_add(m_lockedAt - waitStart, std::memory_order_relaxed);
+    }
+}
+
+void Mutex::profileReleased()
+{
+    if (!m_profile) {
+        return;
+    }
+    const iuint64 holdTime = monotonicTime() - m_lockedAt;
+    iuint64 maxHoldTime = m_profile->m_maxHoldTime.load(std::memory_order_relaxed);
+    while (holdTime > maxHoldTime &&
+           !m_profile->m_maxHoldTime.compare_exchange_weak(maxHoldTime, holdTime, std::memory_order_relaxed)) {
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/**
+  * @return The profiles by "file:line". Function-local, since mutexes are created during static
+  *         initialization.
+  */
+std::map<std::string, MutexProfile*> &mutexProfiles()
+{
+    static std::map<std::string, MutexProfile*> *const profiles = new std::map<std::string, MutexProfile*>;
+    return *profiles;
+}
+
+}
+
+MutexProfile::MutexProfile(const ichar *file, iint32 line)
+    : m_file(file)
+    , m_line(line)
+    , m_acquisitions(0)
+    , m_contentions(0)
+    , m_waitTime(0)
+    , m_maxHoldTime(0)
+{
+}
+
+Mutex &MutexProfile::registryMutex()
+{
+    static Mutex *const mutex = new Mutex(Mutex::NoRecursive, static_cast<MutexProfile*>(0));
+    return *mutex;
+}
+
+MutexProfile *MutexProfile::get(const ichar *file, iint32 line)
+{
+    std::ostringstream key;
+    key << file << ':' << line;
+    ContextMutexLocker cml(registryMutex());
+    MutexProfile *&profile = mutexProfiles()[key.str()];
+    if (!profile) {
+        profile = new MutexProfile(file, line);
+    }
+    return profile;
+}
+
+List<MutexProfile*> MutexProfile::profiles()
+{
+    List<MutexProfile*> res;
+    std::map<std::string, MutexProfile*> &profiles = mutexProfiles();
+    ContextMutexLocker cml(registryMutex());
+    std::map<std::string, MutexProfile*>::const_iterator it;
+    for (it = profiles.begin(); it != profiles.end(); ++it) {
+        res.push_back(it->second);
+    }
+    return res;
+}
+#endif
+
 }
@@ -23,19 +23,81 @@
 
 #include <ideal_export.h>
 
+#include <atomic>
+
+#ifdef IDEAL_MUTEX_PROFILING
+#include <core/list.h>
+#endif
+
 namespace IdealCore {
 
+#ifdef IDEAL_MUTEX_PROFILING
+class Mutex;
+
+/**
+  * @internal
+  *
+  * Lock counters shared by all mutexes created at the same place of the source code. Profiles are
+  * never deleted, so mutexes keep a plain pointer to theirs.
+  *
+  * @see Application::mutexStats
+  */
+class IDEAL_EXPORT MutexProfile
+{
+public:
+    /**
+      * @return The profile of mutexes created at line @p line of @p file, created if it did not
+      *         exist yet.
+      */
+    static MutexProfile *get(const ichar *file, iint32 line);
+
+    /**
+      * @return All profiles created so far.
+      */
+    static List<MutexProfile*> profiles();
+
+    const ichar *const   m_file;
+    const iint32         m_line;
+    std::atomic<iuint64> m_acquisitions;
+    std::atomic<iuint64> m_contentions;  ///< Acquisitions that found the mutex locked
+    std::atomic<iuint64> m_waitTime;     ///< In nanoseconds
+    std::atomic<iuint64> m_maxHoldTime;  ///< In nanoseconds
+
+private:
+    MutexProfile(const ichar *file, iint32 line);
+
+    /**
+      * @return The mutex protecting the profiles, which is not profiled itself.
+      */
+    static Mutex &registryMutex();
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#endif
+
 /**
   * @class Mutex mutex.h core/mutex.h
   *
   * Allows you to protect critical sections when executing several threads accessing/modifying a
   * critical section.
   *
+  * The state of the mutex lives in the object itself: locking and unlocking a free mutex is a
+  * single atomic operation, done inline. A thread that finds the mutex locked spins for a short
+  * while, adapted to how long the mutex was held in the past, before going to sleep.
+  *
+  * When the library is configured with --mutex-profiling, every mutex accounts its acquisitions,
+  * the time spent waiting for it and the time it was held, to the place it was created at.
+  *
+  * @note Mutexes cannot be copied.
+  *
   * @author Rafael Fernández López <ereslibre@ereslibre.es>
   */
 class IDEAL_EXPORT Mutex
 {
     friend class CondVar;
+#ifdef IDEAL_MUTEX_PROFILING
+    friend class MutexProfile;
+#endif
 
 public:
     enum RecursionType {
@@ -43,14 +105,28 @@ public:
         Recursive           ///< This mutex is recursive. Two or more lock() calls from the same thread will not deadlock.
     };
 
+#ifdef IDEAL_MUTEX_PROFILING
+    Mutex(RecursionType recursionType = NoRecursive, const ichar *file = __builtin_FILE(), iint32 line = __builtin_LINE());
+#else
     Mutex(RecursionType recursionType = NoRecursive);
-    Mutex(const Mutex &mutex);
-    virtual ~Mutex();
+#endif
+    ~Mutex();
 
     /**
       * Locks this mutex. If the mutex was already locked we wait until the mutex becomes available.
       */
-    void lock();
+    void lock()
+    {
+        iint32 unlocked = Unlocked;
+        if (IDEAL_LIKELY(m_recursionType == NoRecursive &&
+                         m_state.compare_exchange_strong(unlocked, Locked, std::memory_order_acquire))) {
+#ifdef IDEAL_MUTEX_PROFILING
+            profileAcquired(0);
+#endif
+            return;
+        }
+        lockSlow();
+    }
 
     /**
       * Tries to lock this mutex.
@@ -64,15 +140,69 @@ public:
     /**
       * Unlocks this mutex.
       */
-    void unlock();
+    void unlock()
+    {
+        if (IDEAL_UNLIKELY(m_recursionType == Recursive)) {
+            unlockRecursive();
+            return;
+        }
+#ifdef IDEAL_MUTEX_PROFILING
+        profileReleased();
+#endif
+        if (IDEAL_UNLIKELY(m_state.exchange(Unlocked, std::memory_order_release) == LockedWithWaiters)) {
+            wakeOne();
+        }
+    }
 
     bool operator==(const Mutex &mutex) const;
     bool operator!=(const Mutex &mutex) const;
 
 private:
-    class Private;
-    class PrivateImpl;
-    Private *d;
+    Mutex(const Mutex &mutex);
+    Mutex &operator=(const Mutex &mutex);
+
+#ifdef IDEAL_MUTEX_PROFILING
+    Mutex(RecursionType recursionType, MutexProfile *profile);
+#endif
+
+    enum State {
+        Unlocked = 0,
+        Locked,
+        LockedWithWaiters  ///< Somebody may be sleeping on m_state, so unlock() has to wake it up
+    };
+
+    void lockSlow();
+    void lockState();
+    void lockContended();
+    void unlockRecursive();
+    void wakeOne();
+
+    /**
+      * Fully releases this mutex, even if it was locked recursively, for CondVar to wait.
+      *
+      * @return What has to be given to reacquire() to restore the lock.
+      */
+    iint32 release();
+    void reacquire(iint32 recursion);
+
+#ifdef IDEAL_MUTEX_PROFILING
+    /**
+      * Accounts for the mutex being locked by this thread. @p waitStart is when we started waiting
+      * for it, or 0 if it was unlocked.
+      */
+    void profileAcquired(iint64 waitStart);
+    void profileReleased();
+#endif
+
+    std::atomic<iint32>      m_state;
+    const RecursionType      m_recursionType;
+    std::atomic<iint32>      m_spins;     ///< Average spins that were needed to lock, a hint only
+    std::atomic<const void*> m_owner;     ///< The thread holding a recursive mutex
+    iint32                   m_recursion; ///< How many times the owner locked a recursive mutex
+#ifdef IDEAL_MUTEX_PROFILING
+    MutexProfile *const      m_profile;   ///< Null for the mutex protecting the profiles
+    iint64                   m_lockedAt;  ///< When the current holder locked this mutex
+#endif
 };
 
 }
@@ -21,8 +21,13 @@
 #include "object.h"
 #include "private/object_p.h"
 
-#include "application.h"
-#include "private/application_p.h"
+#include "private/event_loop_p.h"
+
+#include "context_read_locker.h"
+#include "context_write_locker.h"
+
+#include <algorithm>
+#include <vector>
 
 namespace IdealCore {
 
@@ -30,6 +35,15 @@ Object::Private::Private(Object *q)
     : m_deleteChildrenRecursively(true)
     , m_blockedSignals(false)
     , m_emitBlocked(false)
+    , m_firstChild(0)
+    , m_lastChild(0)
+    , m_previousSibling(0)
+    , m_nextSibling(0)
+    , m_connectionsPruneSize(16)
+    , m_guard(0)
+    , m_pendingDeletion(false)
+    , m_deletionSegment(0)
+    , m_deletionIndex(0)
     , q(q)
 {
 }
@@ -40,166 +54,244 @@ Object::Private::~Private()
 
 void Object::Private::addChild(Object *child)
 {
-    ContextMutexLocker cml(m_childrenMutex);
-    m_children.push_back(child);
+    ContextWriteLocker cwl(m_lock);
+    Private *const child_d = child->d;
+    child_d->m_previousSibling = m_lastChild;
+    child_d->m_nextSibling = 0;
+    if (m_lastChild) {
+        m_lastChild->d->m_nextSibling = child;
+    } else {
+        m_firstChild = child;
+    }
+    m_lastChild = child;
 }
 
 void Object::Private::removeChild(Object *child)
 {
-    ContextMutexLocker cml(m_childrenMutex);
-    m_children.remove(child);
+    ContextWriteLocker cwl(m_lock);
+    Private *const child_d = child->d;
+    if (child_d->m_previousSibling) {
+        child_d->m_previousSibling->d->m_nextSibling = child_d->m_nextSibling;
+    } else {
+        m_firstChild = child_d->m_nextSibling;
+    }
+    if (child_d->m_nextSibling) {
+        child_d->m_nextSibling->d->m_previousSibling = child_d->m_previousSibling;
+    } else {
+        m_lastChild = child_d->m_previousSibling;
+    }
+    child_d->m_previousSibling = 0;
+    child_d->m_nextSibling = 0;
 }
 
 void Object::Private::allPredecessors(Object *object, List<Object*> &objectList)
 {
-    List<Object*>::iterator it;
-    ContextMutexLocker cml(object->d->m_childrenMutex);
-    for (it = object->d->m_children.begin(); it != object->d->m_children.end(); ++it) {
-        allPredecessors(*it, objectList);
+    // Objects are visited parents first and prepended, so the list ends up in post-order
+    std::vector<Object*> pending;
+    pending.push_back(object);
+    while (!pending.empty()) {
+        Object *const curr = pending.back();
+        pending.pop_back();
+        objectList.push_front(curr);
+        ContextReadLocker crl(curr->d->m_lock);
+        for (Object *child = curr->d->m_firstChild; child; child = child->d->m_nextSibling) {
+            pending.push_back(child);
+        }
+    }
+}
+
+void Object::Private::setChildrenPool(Object *object, ObjectPool *pool)
+{
+    std::vector<Object*> pending;
+    pending.push_back(object);
+    while (!pending.empty()) {
+        Object *const curr = pending.back();
+        pending.pop_back();
+        if (curr->d->m_childrenPool == curr) {
+            continue;
+        }
+        curr->d->m_childrenPool = pool;
+        ContextReadLocker crl(curr->d->m_lock);
+        for (Object *child = curr->d->m_firstChild; child; child = child->d->m_nextSibling) {
+            pending.push_back(child);
+        }
     }
-    objectList.push_back(object);
 }
 
 void Object::Private::cleanConnections()
 {
-    List<const SignalBase*> signalsToDisconnect;
+    // Releasing the last reference to a callback can destroy a functor, which may do anything,
+    // so that happens with m_lock unlocked
+    List<Connection> connections;
     {
-        ContextMutexLocker cml(m_connectedObjectsMutex);
-        List<GeniousPointer<Object>*>::iterator it = m_connectedObjects.begin();
-        while (it != m_connectedObjects.end()) {
-            GeniousPointer<Object> *connectedObject = *it;
-            if (!connectedObject->isContentDestroyed()) {
-                List<const SignalBase*> connectedObjectSignals = connectedObject->content()->signals();
-                List<const SignalBase*>::iterator sigIt = connectedObjectSignals.begin();
-                while (sigIt != connectedObjectSignals.end()) {
-                    const SignalBase *signalBase = *sigIt;
-                    if (signalBase->m_parent != q) {
-                        signalsToDisconnect.push_back(signalBase);
-                    }
-                    ++sigIt;
-                }
-                ++it;
-            } else {
-                it = m_connectedObjects.erase(it);
-                delete connectedObject;
-            }
-        }
+        ContextWriteLocker cwl(m_lock);
+        connections.swap(m_connections);
     }
-    List<const SignalBase*>::iterator sigIt;
-    for (sigIt = signalsToDisconnect.begin(); sigIt != signalsToDisconnect.end(); ++sigIt) {
-        (*sigIt)->disconnect(q);
+    List<Connection>::iterator it;
+    for (it = connections.begin(); it != connections.end(); ++it) {
+        (*it).disconnect();
     }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 Object::Object(Object *parent)
-    : d(new Private(this))
+    : d(new (parent ? parent->d->m_childrenPool : 0) Private(this))
     , destroyed(Signal<>(this))
 {
     d->m_parent = parent;
     if (!parent) {
         IDEAL_DEBUG_WARNING("parent of object is null. This is wrong and will cause problems");
         d->m_application = 0;
+        d->m_eventLoop = 0;
+        d->m_childrenEventLoop = 0;
+        d->m_childrenPool = 0;
         return;
     }
     d->m_application = parent->d->m_application;
+    d->m_eventLoop = parent->d->m_childrenEventLoop;
+    d->m_childrenEventLoop = d->m_eventLoop;
+    d->m_childrenPool = parent->d->m_childrenPool;
     parent->d->addChild(this);
 }
 
 Object::~Object()
 {
-    m_mutex.tryLock();
-    m_mutex.unlock();
+    ObjectGuard *const guard = d->m_guard.load(std::memory_order_acquire);
+    if (guard) {
+        guard->m_destroyed.store(true, std::memory_order_release);
+    }
+    if (d->m_pendingDeletion.load()) {
+        d->m_eventLoop->cancelDeleteLater(this);
+    }
     destroyed.emit();
     d->cleanConnections();
     {
-        ContextMutexLocker cml(d->m_parentMutex);
+        ContextWriteLocker cwl(d->m_lock);
         if (d->m_parent) {
             d->m_parent->d->removeChild(this);
         }
     }
-    d->m_deleteChildrenRecursivelyMutex.lock();
-    if (d->m_deleteChildrenRecursively) {
+    if (d->m_deleteChildrenRecursively.load()) {
         List<Object*> objectsToDelete;
         d->allPredecessors(this, objectsToDelete);
         objectsToDelete.pop_back(); // 'this' is the last element, and we are already deleting it =)
         List<Object*>::iterator it;
         for (it = objectsToDelete.begin(); it != objectsToDelete.end(); ++it) {
-            Object *const currObject = *it;
-            currObject->m_mutex.lock();
-            delete currObject;
+            delete *it;
+        }
+    } else {
+        // Children that survive us are left without parent, instead of pointing to freed memory
+        const List<Object*> survivors = children();
+        List<Object*>::const_iterator it;
+        for (it = survivors.begin(); it != survivors.end(); ++it) {
+            Private *const child_d = (*it)->d;
+            ContextWriteLocker cwl(child_d->m_lock);
+            if (child_d->m_parent == this) {
+                child_d->m_parent = 0;
+                child_d->m_previousSibling = 0;
+                child_d->m_nextSibling = 0;
+            }
         }
     }
-    d->m_deleteChildrenRecursivelyMutex.unlock();
     delete d;
+    if (guard) {
+        guard->deref();
+    }
+}
+
+void *Object::operator new(size_t size)
+{
+    return ObjectPool::allocate(size, 0);
+}
+
+void *Object::operator new(size_t size, ObjectPool *pool)
+{
+    return ObjectPool::allocate(size, pool);
+}
+
+void Object::operator delete(void *ptr)
+{
+    ObjectPool::deallocate(ptr);
+}
+
+void Object::operator delete(void *ptr, ObjectPool *pool)
+{
+    ObjectPool::deallocate(ptr);
 }
 
 void Object::setDeleteChildrenRecursively(bool deleteChildrenRecursively)
 {
-    ContextMutexLocker cml(d->m_deleteChildrenRecursivelyMutex);
-    d->m_deleteChildrenRecursively = deleteChildrenRecursively;
+    d->m_deleteChildrenRecursively.store(deleteChildrenRecursively);
 }
 
 bool Object::isDeleteChildrenRecursively() const
 {
-    ContextMutexLocker cml(d->m_deleteChildrenRecursivelyMutex);
-    return d->m_deleteChildrenRecursively;
+    return d->m_deleteChildrenRecursively.load();
 }
 
 void Object::setBlockedSignals(bool blockedSignals)
 {
-    ContextMutexLocker cml(d->m_blockedSignalsMutex);
-    d->m_blockedSignals = blockedSignals;
+    d->m_blockedSignals.store(blockedSignals, std::memory_order_release);
 }
 
 bool Object::areSignalsBlocked() const
 {
-    ContextMutexLocker cml(d->m_blockedSignalsMutex);
-    return d->m_blockedSignals;
+    return d->m_blockedSignals.load(std::memory_order_acquire);
 }
 
 void Object::setEmitBlocked(bool emitBlocked)
 {
-    ContextMutexLocker cml(d->m_emitBlockedMutex);
-    d->m_emitBlocked = emitBlocked;
+    d->m_emitBlocked.store(emitBlocked, std::memory_order_release);
 }
 
 bool Object::isEmitBlocked() const
 {
-    ContextMutexLocker cml(d->m_emitBlockedMutex);
-    return d->m_emitBlocked;
+    return d->m_emitBlocked.load(std::memory_order_acquire);
 }
 
 List<Object*> Object::children() const
 {
-    ContextMutexLocker cml(d->m_childrenMutex);
-    return d->m_children;
+    List<Object*> res;
+    ContextReadLocker crl(d->m_lock);
+    for (Object *child = d->m_firstChild; child; child = child->d->m_nextSibling) {
+        res.push_back(child);
+    }
+    return res;
 }
 
 Object *Object::parent() const
 {
-    ContextMutexLocker cml(d->m_parentMutex);
+    ContextReadLocker crl(d->m_lock);
     return d->m_parent;
 }
 
 void Object::reparent(Object *parent)
 {
-    ContextMutexLocker cml(d->m_parentMutex);
-    if (d->m_parent == parent) {
-        return;
-    }
-    if (d->m_application && (d->m_application != parent->d->m_application)) {
-        IDEAL_DEBUG_WARNING("could not reparent. Trying to reparent a child to a parent that is in a different Application object");
-        return;
-    }
-    if (d->m_parent) {
-        d->m_parent->d->removeChild(this);
-    }
-    d->m_parent = parent;
-    if (parent) {
-        parent->d->addChild(this);
+    {
+        ContextWriteLocker cwl(d->m_lock);
+        if (d->m_parent == parent) {
+            return;
+        }
+        if (d->m_application && (d->m_application != parent->d->m_application)) {
+            IDEAL_DEBUG_WARNING("could not reparent. Trying to reparent a child to a parent that is in a different Application object");
+            return;
+        }
+        if (d->m_eventLoop && (d->m_eventLoop != parent->d->m_childrenEventLoop)) {
+            IDEAL_DEBUG_WARNING("could not reparent. Trying to reparent a child to a parent whose children belong to a different event loop");
+            return;
+        }
+        if (d->m_parent) {
+            d->m_parent->d->removeChild(this);
+        }
+        d->m_parent = parent;
+        if (parent) {
+            parent->d->addChild(this);
+        }
     }
+    // The subtree now belongs to the pool of the new parent, if any. Locks of children are taken
+    // one at a time, so ours must not be held
+    Private::setChildrenPool(this, parent ? parent->d->m_childrenPool : 0);
 }
 
 Application *Object::application() const
@@ -209,35 +301,16 @@ Application *Object::application() const
 
 void Object::disconnectSender(Object *sender)
 {
+    List<const SignalBase*> signals = sender->signals();
     List<const SignalBase*>::iterator it;
-    ContextMutexLocker cml(sender->d->m_signalsMutex);
-    for (it = sender->d->m_signals.begin(); it != sender->d->m_signals.end(); ++it) {
+    for (it = signals.begin(); it != signals.end(); ++it) {
         (*it)->disconnect();
     }
 }
 
 void Object::disconnectReceiver(Object *receiver)
 {
-    List<const SignalBase*> signalsToDisconnect;
-    List<GeniousPointer<Object>*>::iterator it;
-    {
-        ContextMutexLocker cml(receiver->d->m_connectedObjectsMutex);
-        for (it = receiver->d->m_connectedObjects.begin(); it != receiver->d->m_connectedObjects.end(); ++it) {
-            GeniousPointer<Object> *const object = *it;
-            if (!object->isContentDestroyed()) {
-                Object *const obj = object->content();
-                List<const SignalBase*>::iterator sigIt;
-                ContextMutexLocker cml(obj->d->m_signalsMutex);
-                for (sigIt = obj->d->m_signals.begin(); sigIt != obj->d->m_signals.end(); ++sigIt) {
-                    signalsToDisconnect.push_back(*sigIt);
-                }
-            }
-        }
-    }
-    List<const SignalBase*>::iterator sigIt;
-    for (sigIt = signalsToDisconnect.begin(); sigIt != signalsToDisconnect.end(); ++sigIt) {
-        (*sigIt)->disconnect(receiver);
-    }
+    receiver->d->cleanConnections();
 }
 
 void Object::fullyDisconnect(Object *object)
@@ -253,54 +326,93 @@ void Object::deleteNow()
 
 void Object::deleteLater()
 {
-    List<Object*>::iterator it;
-    ContextMutexLocker cml(d->m_application->d->m_markedForDeletionMutex);
-    for (it = d->m_application->d->m_markedForDeletion.begin(); it != d->m_application->d->m_markedForDeletion.end(); ++it) {
-        if (*it == this) {
-            return;
-        }
-    }
-    d->m_application->d->m_markedForDeletion.push_back(this);
+    d->m_eventLoop->deleteLater(this);
 }
 
-void Object::signalCreated(const SignalBase *signal)
+void Object::postQueuedCall(QueuedCall *queuedCall)
 {
-    ContextMutexLocker cml(d->m_signalsMutex);
-    d->m_signals.push_back(signal);
+    if (!d->m_eventLoop) {
+        queuedCall->run();
+        delete queuedCall;
+        return;
+    }
+    d->m_eventLoop->postQueuedCall(queuedCall);
 }
 
-void Object::signalConnected(const SignalBase *signal)
+void Object::signalCreated(const SignalBase *signal)
 {
-    ContextMutexLocker cml(d->m_connectedObjectsMutex);
-    d->m_connectedObjects.push_back(new GeniousPointer<Object>(dynamic_cast<Object*>(signal->m_parent)));
+    ContextWriteLocker cwl(d->m_lock);
+    d->m_signals.push_back(signal);
 }
 
-void Object::signalDisconnected(const SignalBase *signal)
+void Object::signalConnected(const SignalBase *signal, const Connection &connection)
 {
-    List<GeniousPointer<Object>*>::iterator it;
-    ContextMutexLocker cml(d->m_connectedObjectsMutex);
-    for (it = d->m_connectedObjects.begin(); it != d->m_connectedObjects.end(); ++it) {
-        GeniousPointer<Object> *connectedObject = *it;
-        if (connectedObject->content() == signal->m_parent) {
-            d->m_connectedObjects.erase(it);
-            delete connectedObject;
-            return;
+    ContextWriteLocker cwl(d->m_lock);
+    if (d->m_connections.size() >= d->m_connectionsPruneSize) {
+        List<Connection>::iterator it = d->m_connections.begin();
+        while (it != d->m_connections.end()) {
+            if (!(*it).isConnected()) {
+                it = d->m_connections.erase(it);
+                continue;
+            }
+            ++it;
         }
+        d->m_connectionsPruneSize = std::max(d->m_connectionsPruneSize, d->m_connections.size() * 2);
     }
+    d->m_connections.push_back(connection);
 }
 
 List<const SignalBase*> Object::signals() const
 {
-    ContextMutexLocker cml(d->m_signalsMutex);
+    ContextReadLocker crl(d->m_lock);
     return d->m_signals;
 }
 
 Object::Object()
-    : d(new Private(this))
+    : d(new (0) Private(this))
     , destroyed(Signal<>(this))
 {
     d->m_parent = 0;
     d->m_application = 0;
+    d->m_eventLoop = 0;
+    d->m_childrenEventLoop = 0;
+    d->m_childrenPool = 0;
+}
+
+ObjectGuard *Object::guard() const
+{
+    ObjectGuard *guard = d->m_guard.load(std::memory_order_acquire);
+    if (!guard) {
+        // The reference of the new guard is owned by this object
+        ObjectGuard *const newGuard = new ObjectGuard;
+        if (d->m_guard.compare_exchange_strong(guard, newGuard, std::memory_order_acq_rel)) {
+            guard = newGuard;
+        } else {
+            delete newGuard;
+        }
+    }
+    guard->ref();
+    return guard;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+QueuedCall::QueuedCall(Object *receiver)
+    : m_next(0)
+    , m_receiver(receiver)
+{
+}
+
+QueuedCall::~QueuedCall()
+{
+}
+
+void QueuedCall::run()
+{
+    if (m_receiver.isContentDestroyed() || m_receiver->areSignalsBlocked()) {
+        return;
+    }
+    call();
 }
 
 }
@@ -27,6 +27,7 @@
 namespace IdealCore {
 
 class Application;
+class ObjectPool;
 
 /**
   * @class Object object.h core/object.h
@@ -48,13 +49,31 @@ class IDEAL_EXPORT Object
     friend class Extension;
     friend class Module;
     friend class Timer;
+    friend class WorkerThread;
+    friend class ObjectPool;
 
 public:
     Object(Object *parent);
     virtual ~Object();
 
+    /**
+      * Allocates objects from the heap.
+      */
+    static void *operator new(size_t size);
+
+    /**
+      * Allocates objects from @p pool, or from the heap if @p pool is 0.
+      *
+      * @see ObjectPool
+      */
+    static void *operator new(size_t size, ObjectPool *pool);
+
+    static void operator delete(void *ptr);
+    static void operator delete(void *ptr, ObjectPool *pool);
+
     /**
       * Sets whether children of this object should be deleted recursively when this object is.
+      * Otherwise, they are left without parent.
       */
     void setDeleteChildrenRecursively(bool deleteChildrenRecursively);
 
@@ -68,6 +87,10 @@ public:
     /**
       * Sets whether signals are blocked for this object or not. If @p blockedSignals is true, this
       * object won't receive any call coming from a signal.
+      *
+      * @note This does not wait for slots that are already running on other threads. Slots called
+      *       after this method returns will see the new value, and a thread that sees it also sees
+      *       every change this thread did before setting it (release/acquire ordering).
       */
     void setBlockedSignals(bool blockedSignals);
 
@@ -82,6 +105,8 @@ public:
       * Sets whether emit() is blocked for all signals of this object.
       *
       * @note destroyed signal will always be emitted, even if emit() is blocked for this object.
+      *
+      * @note As with setBlockedSignals(), emissions already in progress are not waited for.
       */
     void setEmitBlocked(bool emitBlocked);
 
@@ -145,25 +170,36 @@ public:
     void deleteNow();
 
     /**
-      * Deletes this object on the next event loop.
+      * Deletes this object on the next iteration of the event loop it belongs to.
       */
     void deleteLater();
 
-protected:
     /**
       * @internal
+      *
+      * Queues @p queuedCall to be run on the event loop this object belongs to. It can be called
+      * from any thread. The event loop takes ownership of @p queuedCall.
       */
-    virtual void signalCreated(const SignalBase *signal);
+    void postQueuedCall(QueuedCall *queuedCall);
+
+    /**
+      * @internal
+      *
+      * @return The guard that tells whether this object is still alive, referenced for the caller,
+      *         who has to deref() it when done.
+      */
+    ObjectGuard *guard() const;
 
+protected:
     /**
       * @internal
       */
-    virtual void signalConnected(const SignalBase *signal);
+    virtual void signalCreated(const SignalBase *signal);
 
     /**
       * @internal
       */
-    virtual void signalDisconnected(const SignalBase *signal);
+    virtual void signalConnected(const SignalBase *signal, const Connection &connection);
 
     /**
       * @internal
@@ -178,6 +214,7 @@ private:
 
     class Private;
     Private *const d;
+    friend class EventLoop;
 
 public:
     IDEAL_SIGNAL(destroyed);
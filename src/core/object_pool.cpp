@@ -0,0 +1,160 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "object_pool.h"
+#include "private/object_pool_p.h"
+#include "private/object_p.h"
+
+#include <new>
+#include <stdlib.h>
+
+namespace IdealCore {
+
+ObjectPool::Private::Private()
+    : m_slabCursor(0)
+    , m_slabEnd(0)
+    , m_allocatedBlocks(0)
+    , m_poolDestroyed(false)
+{
+    for (iint32 i = 0; i < SizeClasses; ++i) {
+        m_freeLists[i] = 0;
+    }
+}
+
+ObjectPool::Private::~Private()
+{
+    std::vector<ichar*>::iterator it;
+    for (it = m_slabs.begin(); it != m_slabs.end(); ++it) {
+        free(*it);
+    }
+}
+
+void *ObjectPool::Private::allocate(iint32 sizeClass)
+{
+    ContextMutexLocker cml(m_mutex);
+    ++m_allocatedBlocks;
+    FreeBlock *const block = m_freeLists[sizeClass];
+    if (block) {
+        m_freeLists[sizeClass] = block->m_next;
+        return block;
+    }
+    const size_t blockSize = (sizeClass + 1) * Granularity;
+    if (m_slabCursor + blockSize > m_slabEnd) {
+        // What is left of the last slab is wasted; it is smaller than the largest size class
+        ichar *const slab = static_cast<ichar*>(malloc(SlabSize));
+        if (!slab) {
+            throw std::bad_alloc();
+        }
+        m_slabs.push_back(slab);
+        m_slabCursor = slab;
+        m_slabEnd = slab + SlabSize;
+    }
+    void *const res = m_slabCursor;
+    m_slabCursor += blockSize;
+    return res;
+}
+
+bool ObjectPool::Private::deallocate(void *ptr, iint32 sizeClass)
+{
+    ContextMutexLocker cml(m_mutex);
+    FreeBlock *const block = static_cast<FreeBlock*>(ptr);
+    block->m_next = m_freeLists[sizeClass];
+    m_freeLists[sizeClass] = block;
+    return !--m_allocatedBlocks && m_poolDestroyed;
+}
+
+bool ObjectPool::Private::poolDestroyed()
+{
+    ContextMutexLocker cml(m_mutex);
+    m_poolDestroyed = true;
+    return !m_allocatedBlocks;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ObjectPool::ObjectPool(Object *parent)
+    : Object(parent)
+    , d(new Private)
+{
+    Object::d->m_childrenPool = this;
+}
+
+ObjectPool::~ObjectPool()
+{
+    // Children that are not deleted recursively outlive the pool, and must not allocate from it
+    // anymore
+    const List<Object*> poolChildren = children();
+    List<Object*>::const_iterator it;
+    for (it = poolChildren.begin(); it != poolChildren.end(); ++it) {
+        Object::Private::setChildrenPool(*it, 0);
+    }
+    // Our children are still alive until ~Object deletes them; the last block freed deletes the
+    // arena
+    if (d->poolDestroyed()) {
+        delete d;
+    }
+}
+
+size_t ObjectPool::allocatedBlocks() const
+{
+    ContextMutexLocker cml(d->m_mutex);
+    return d->m_allocatedBlocks;
+}
+
+size_t ObjectPool::reservedMemory() const
+{
+    ContextMutexLocker cml(d->m_mutex);
+    return d->m_slabs.size() * Private::SlabSize;
+}
+
+void *ObjectPool::allocate(size_t size, ObjectPool *pool)
+{
+    const size_t blockSize = size + sizeof(Private::BlockHeader);
+    Private::BlockHeader *header;
+    if (pool && blockSize <= Private::MaxBlockSize) {
+        const iint32 sizeClass = (blockSize - 1) / Private::Granularity;
+        header = static_cast<Private::BlockHeader*>(pool->d->allocate(sizeClass));
+        header->m_arena = pool->d;
+        header->m_sizeClass = sizeClass;
+    } else {
+        header = static_cast<Private::BlockHeader*>(::operator new(blockSize));
+        header->m_arena = 0;
+        header->m_sizeClass = 0;
+    }
+    return header + 1;
+}
+
+void ObjectPool::deallocate(void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+    Private::BlockHeader *const header = static_cast<Private::BlockHeader*>(ptr) - 1;
+    Private *const arena = header->m_arena;
+    if (!arena) {
+        ::operator delete(header);
+        return;
+    }
+    if (arena->deallocate(header, header->m_sizeClass)) {
+        delete arena;
+    }
+}
+
+}
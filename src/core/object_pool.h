@@ -0,0 +1,93 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <ideal_export.h>
+#include <core/object.h>
+
+namespace IdealCore {
+
+/**
+  * @class ObjectPool object_pool.h core/object_pool.h
+  *
+  * An arena for objects that are created and destroyed very often. Objects created with
+  * new (pool) are taken from slabs owned by the pool instead of the heap, and so is the private
+  * data of every object whose parent is the pool or a descendant of it:
+  *
+  * @code
+  * ObjectPool *pool = new ObjectPool(&app);
+  * for (iint32 i = 0; i < requests; ++i) {
+  *     MyRequest *request = new (pool) MyRequest(pool);
+  *     // code
+  * }
+  * delete pool; // deletes the requests that are left and releases all their memory at once
+  * @endcode
+  *
+  * Deleting pooled objects only puts their memory back on the free lists of the pool, so it can
+  * be reused by the next object of a similar size. The slabs are given back to the system all
+  * together, once the pool has been deleted and no object allocated from it is alive. Objects are
+  * still destroyed one by one, so their destructors and the destroyed signal work as usual.
+  *
+  * @note Objects bigger than 512 bytes are allocated from the heap even if a pool is given.
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class IDEAL_EXPORT ObjectPool
+    : public Object
+{
+public:
+    ObjectPool(Object *parent);
+    virtual ~ObjectPool();
+
+    /**
+      * @return The number of blocks allocated from this pool that have not been freed yet. Every
+      *         pooled object uses two: one for the object and one for its private data.
+      */
+    size_t allocatedBlocks() const;
+
+    /**
+      * @return The memory taken by the slabs of this pool, in bytes.
+      */
+    size_t reservedMemory() const;
+
+    /**
+      * @internal
+      *
+      * Allocates @p size bytes from @p pool, or from the heap if @p pool is 0.
+      */
+    static void *allocate(size_t size, ObjectPool *pool);
+
+    /**
+      * @internal
+      *
+      * Frees @p ptr, which was returned by allocate(), wherever it was taken from.
+      */
+    static void deallocate(void *ptr);
+
+private:
+    class Private;
+    Private *const d;
+};
+
+}
+
+#endif //OBJECT_POOL_H
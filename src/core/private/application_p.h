@@ -22,7 +22,10 @@
 #define APPLICATION_P_H
 
 #include <vector>
+#include <core/read_write_lock.h>
 #include <core/option.h>
+#include <core/private/event_dispatcher_p.h>
+#include <core/private/event_loop_p.h>
 
 namespace IdealCore {
 
@@ -36,30 +39,20 @@ public:
     Private(Application *q);
     virtual ~Private();
 
-    void processEvents();
-    void processDelayedDeletions();
     void checkFileWatches();
     void unloadUnneededDynamicLibraries();
 
-    static bool timerSort(const Timer *left, const Timer *right);
-    void checkTimers();
-
     iint32                   m_argc;
     ichar                  **m_argv;
     String                   m_name;
     Locale                   m_locale;
     bool                     m_prefixSet;
-    iint32                   m_sleepTime;
-    const iint32             m_defaultSleepTime;
-    List<Object*>            m_markedForDeletion;
-    Mutex                    m_markedForDeletionMutex;
     List<IdealCore::Module*> m_markedForUnload;
     Mutex                    m_markedForUnloadMutex;
-    std::vector<Timer*>      m_runningTimerList;
-    Mutex                    m_runningTimerListMutex;
-    iint32                   m_nextTimeout;
     List<ProtocolHandler*>   m_protocolHandlerCache;
-    Mutex                    m_protocolHandlerCacheMutex;
+    ReadWriteLock            m_protocolHandlerCacheLock;
+    EventLoop                m_eventLoop;
+    EventDispatcherPool      m_eventDispatcherPool;
     Application             *q;
 };
 
@@ -21,7 +21,6 @@
 #ifndef COND_VAR_P_H
 #define COND_VAR_P_H
 
-#include <pthread.h>
 #include <core/cond_var.h>
 #include <core/mutex.h>
 
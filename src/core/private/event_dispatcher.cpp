@@ -25,39 +25,239 @@
 #include <core/timer.h>
 #include <core/event.h>
 
+#define DEFAULT_POOL_SIZE   4
+#define DEFAULT_QUEUE_DEPTH 1024
+
 namespace IdealCore {
 
-EventDispatcher::EventDispatcher(Object *parent)
-    : Thread(parent, NoJoinable)
-    , m_event(0)
+EventDispatcher::EventDispatcher()
 {
 }
 
 EventDispatcher::~EventDispatcher()
 {
-    delete m_event;
 }
 
-void EventDispatcher::postEvent(Event *event)
+void EventDispatcher::dispatchEvent(Event *event)
 {
-    m_event = event;
-}
-
-void EventDispatcher::run()
-{
-    if (!m_event || !m_event->object()) {
+    if (!event->object()) {
         return;
     }
-    switch (m_event->type()) {
+    switch (event->type()) {
         case Event::Timeout: {
-            Timer *const timer = static_cast<Timer*>(m_event->object());
+            Timer *const timer = static_cast<Timer*>(event->object());
             timer->timeout.emit();
         }
             break;
         default:
-            IDEAL_DEBUG_WARNING("Unexpected event type " << m_event->type());
+            IDEAL_DEBUG_WARNING("Unexpected event type " << event->type());
             break;
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+EventDispatcherPool::Worker::Worker(Object *parent, EventDispatcherPool *pool)
+    : Thread(parent, Joinable)
+    , m_pool(pool)
+    , m_retired(false)
+    , m_finished(false)
+{
+    m_stats.eventsDispatched = 0;
+    m_stats.busyTime = 0;
+    m_stats.busy = false;
+}
+
+void EventDispatcherPool::Worker::run()
+{
+    IDEAL_FOREVER {
+        Job job;
+        {
+            ContextMutexLocker cml(m_pool->m_mutex);
+            while (m_pool->m_queue.empty() && !m_retired && !m_pool->m_stopping) {
+                m_pool->m_queueNotEmpty.wait();
+            }
+            if (m_retired || m_pool->m_stopping) {
+                m_finished = true;
+                return;
+            }
+            job = m_pool->m_queue.front();
+            m_pool->m_queue.pop_front();
+            m_pool->m_queueNotFull.signal();
+            m_stats.busy = true;
+        }
+        const iint64 dispatchStart = Timer::monotonicTime();
+        job.eventDispatcher->dispatchEvent(job.event);
+        delete job.event;
+        const iint64 dispatchTime = Timer::monotonicTime() - dispatchStart;
+        {
+            ContextMutexLocker cml(m_pool->m_mutex);
+            ++m_stats.eventsDispatched;
+            m_stats.busyTime += dispatchTime / 1000;
+            m_stats.busy = false;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+EventDispatcherPool::EventDispatcherPool(Object *parent)
+    : m_parent(parent)
+    , m_size(DEFAULT_POOL_SIZE)
+    , m_queueDepth(DEFAULT_QUEUE_DEPTH)
+    , m_stopping(false)
+    , m_queueNotEmpty(m_mutex)
+    , m_queueNotFull(m_mutex)
+{
+}
+
+EventDispatcherPool::~EventDispatcherPool()
+{
+    {
+        ContextMutexLocker cml(m_mutex);
+        m_stopping = true;
+        m_queueNotEmpty.broadcast();
+        m_queueNotFull.broadcast();
+    }
+    std::vector<Worker*>::iterator it;
+    for (it = m_workers.begin(); it != m_workers.end(); ++it) {
+        m_retiredWorkers.push_back(*it);
+    }
+    m_workers.clear();
+    List<Worker*>::iterator retiredIt;
+    for (retiredIt = m_retiredWorkers.begin(); retiredIt != m_retiredWorkers.end(); ++retiredIt) {
+        Worker *const worker = *retiredIt;
+        worker->join();
+        delete worker;
+    }
+    std::deque<Job>::iterator jobIt;
+    for (jobIt = m_queue.begin(); jobIt != m_queue.end(); ++jobIt) {
+        delete jobIt->event;
+    }
+}
+
+void EventDispatcherPool::postEvent(Event *event, EventDispatcher *eventDispatcher)
+{
+    Job job;
+    job.event = event;
+    job.eventDispatcher = eventDispatcher ? eventDispatcher : &m_defaultEventDispatcher;
+    ContextMutexLocker cml(m_mutex);
+    if (m_workers.empty() && !m_stopping) {
+        startWorkers();
+    }
+    while ((iint32) m_queue.size() >= m_queueDepth && !m_stopping) {
+        m_queueNotFull.wait();
+    }
+    if (m_stopping) {
+        delete event;
+        return;
+    }
+    m_queue.push_back(job);
+    m_queueNotEmpty.signal();
+}
+
+bool EventDispatcherPool::tryPostEvent(Event *event, EventDispatcher *eventDispatcher)
+{
+    Job job;
+    job.event = event;
+    job.eventDispatcher = eventDispatcher ? eventDispatcher : &m_defaultEventDispatcher;
+    ContextMutexLocker cml(m_mutex);
+    if (m_stopping || (iint32) m_queue.size() >= m_queueDepth) {
+        return false;
+    }
+    if (m_workers.empty()) {
+        startWorkers();
+    }
+    m_queue.push_back(job);
+    m_queueNotEmpty.signal();
+    return true;
+}
+
+void EventDispatcherPool::setSize(iint32 size)
+{
+    if (size < 1) {
+        IDEAL_DEBUG_WARNING("the dispatcher pool needs at least one worker");
+        return;
+    }
+    ContextMutexLocker cml(m_mutex);
+    m_size = size;
+    reapRetiredWorkers();
+    if (m_workers.empty()) {
+        return;
+    }
+    while ((iint32) m_workers.size() > m_size) {
+        Worker *const worker = m_workers.back();
+        worker->m_retired = true;
+        m_retiredWorkers.push_back(worker);
+        m_workers.pop_back();
+    }
+    m_queueNotEmpty.broadcast();
+    startWorkers();
+}
+
+iint32 EventDispatcherPool::size() const
+{
+    ContextMutexLocker cml(m_mutex);
+    return m_size;
+}
+
+void EventDispatcherPool::setQueueDepth(iint32 queueDepth)
+{
+    if (queueDepth < 1) {
+        IDEAL_DEBUG_WARNING("the dispatcher queue depth has to be at least one");
+        return;
+    }
+    ContextMutexLocker cml(m_mutex);
+    m_queueDepth = queueDepth;
+    m_queueNotFull.broadcast();
+}
+
+iint32 EventDispatcherPool::queueDepth() const
+{
+    ContextMutexLocker cml(m_mutex);
+    return m_queueDepth;
+}
+
+iint32 EventDispatcherPool::pendingEvents() const
+{
+    ContextMutexLocker cml(m_mutex);
+    return m_queue.size();
+}
+
+List<Application::DispatcherStats> EventDispatcherPool::stats() const
+{
+    List<Application::DispatcherStats> res;
+    ContextMutexLocker cml(m_mutex);
+    std::vector<Worker*>::const_iterator it;
+    for (it = m_workers.begin(); it != m_workers.end(); ++it) {
+        res.push_back((*it)->m_stats);
+    }
+    return res;
+}
+
+void EventDispatcherPool::startWorkers()
+{
+    while ((iint32) m_workers.size() < m_size) {
+        Worker *const worker = new Worker(m_parent, this);
+        m_workers.push_back(worker);
+        worker->exec();
+    }
+}
+
+void EventDispatcherPool::reapRetiredWorkers()
+{
+    // Workers only set m_finished right before returning, so joining them does not block for long
+    List<Worker*>::iterator it = m_retiredWorkers.begin();
+    while (it != m_retiredWorkers.end()) {
+        Worker *const worker = *it;
+        if (!worker->m_finished) {
+            ++it;
+            continue;
+        }
+        worker->join();
+        delete worker;
+        it = m_retiredWorkers.erase(it);
+    }
+}
+
 }
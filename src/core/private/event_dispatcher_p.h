@@ -21,27 +21,106 @@
 #ifndef EVENT_DISPATCHER_H
 #define EVENT_DISPATCHER_H
 
+#include <deque>
+#include <vector>
+
 #include <ideal_export.h>
 #include <core/thread.h>
+#include <core/cond_var.h>
+#include <core/application.h>
 
 namespace IdealCore {
 
 class Event;
 
+/**
+  * Knows how to deliver an event to its object. Events are posted to an EventDispatcherPool
+  * together with the dispatcher that has to handle them, and dispatchEvent() is called from one
+  * of the pool workers.
+  */
 class IDEAL_EXPORT EventDispatcher
-    : public Thread
 {
 public:
-    EventDispatcher(Object *parent);
+    EventDispatcher();
     virtual ~EventDispatcher();
 
-    void postEvent(Event *event);
+    virtual void dispatchEvent(Event *event);
+};
+
+/**
+  * A fixed set of worker threads consuming events from a bounded queue. Workers are only created
+  * when the first event is posted, so applications that never post events never spawn threads.
+  */
+class EventDispatcherPool
+{
+public:
+    EventDispatcherPool(Object *parent);
+    ~EventDispatcherPool();
+
+    /**
+      * Queues @p event, that will be handled by @p eventDispatcher, or by the default dispatcher
+      * if 0. The pool takes ownership of @p event. If the queue is full, the calling thread blocks
+      * until a worker makes room.
+      */
+    void postEvent(Event *event, EventDispatcher *eventDispatcher = 0);
+
+    /**
+      * Like postEvent(), but never blocks. If the queue is full or the pool is being destroyed,
+      * @p event is not queued and the caller keeps its ownership.
+      *
+      * @return Whether @p event was queued.
+      */
+    bool tryPostEvent(Event *event, EventDispatcher *eventDispatcher = 0);
+
+    void setSize(iint32 size);
+    iint32 size() const;
+
+    void setQueueDepth(iint32 queueDepth);
+    iint32 queueDepth() const;
+
+    iint32 pendingEvents() const;
+
+    List<Application::DispatcherStats> stats() const;
+
+private:
+    struct Job {
+        Event           *event;
+        EventDispatcher *eventDispatcher;
+    };
+
+    class Worker
+        : public Thread
+    {
+    public:
+        Worker(Object *parent, EventDispatcherPool *pool);
+
+        EventDispatcherPool          *m_pool;
+        bool                          m_retired;
+        bool                          m_finished;    ///< Set when run() is about to return
+        Application::DispatcherStats  m_stats;
+
+    protected:
+        virtual void run();
+    };
+
+    void startWorkers();
 
-protected:
-    virtual void run();
+    /**
+      * Joins and deletes the retired workers that already left run(). Called with m_mutex locked.
+      */
+    void reapRetiredWorkers();
 
-protected:
-    Event *m_event;
+    Object               *m_parent;
+    iint32                m_size;
+    iint32                m_queueDepth;
+    bool                  m_stopping;
+    std::deque<Job>       m_queue;
+    std::vector<Worker*>  m_workers;
+    List<Worker*>         m_retiredWorkers;
+    EventDispatcher       m_defaultEventDispatcher;
+    mutable Mutex         m_mutex;
+    CondVar               m_queueNotEmpty;
+    CondVar               m_queueNotFull;
 };
 
 }
@@ -0,0 +1,195 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "event_loop_p.h"
+#include "event_dispatcher_p.h"
+#include "timer_p.h"
+#include "object_p.h"
+
+#include <core/event.h>
+
+namespace IdealCore {
+
+void EventLoop::exec()
+{
+    while (!m_quit.load()) {
+        processEvents();
+    }
+    processDelayedDeletions();
+    m_quit.store(false);
+}
+
+void EventLoop::quit()
+{
+    m_quit.store(true);
+    wakeUp();
+}
+
+void EventLoop::processEvents()
+{
+    waitForEvents(checkTimers());
+    processQueuedCalls();
+    processDelayedDeletions();
+}
+
+iint64 EventLoop::checkTimers()
+{
+    List<Timer*> expiredTimerList;
+    iint64 nextDeadline = -1;
+    {
+        ContextMutexLocker cml(m_runningTimersMutex);
+        const iint64 now = Timer::monotonicTime();
+        while (!m_runningTimers.empty() && m_runningTimers.top()->d->m_deadline <= now) {
+            Timer *const currTimer = m_runningTimers.pop();
+            Timer::LatenessStats &latenessStats = currTimer->d->m_latenessStats;
+            const iint64 lateness = now - currTimer->d->m_deadline;
+            ++latenessStats.timeouts;
+            latenessStats.lastLateness = lateness;
+            latenessStats.totalLateness += lateness;
+            if (lateness > latenessStats.maxLateness) {
+                latenessStats.maxLateness = lateness;
+            }
+            if (currTimer->d->m_timeoutType == Timer::SingleShot) {
+                currTimer->d->m_state = Timer::Stopped;
+            }
+            expiredTimerList.push_back(currTimer);
+        }
+        // Periodic timers are pushed back once all expired timers have been collected, so that a
+        // timer with a null interval does not keep us forever in the loop above.
+        List<Timer*>::iterator it;
+        for (it = expiredTimerList.begin(); it != expiredTimerList.end(); ++it) {
+            Timer *const currTimer = *it;
+            if (currTimer->d->m_timeoutType == Timer::NoSingleShot) {
+                currTimer->d->reschedule(now);
+                m_runningTimers.push(currTimer);
+            }
+        }
+        if (!m_runningTimers.empty()) {
+            nextDeadline = m_runningTimers.top()->d->m_deadline;
+        }
+    }
+    List<Timer*>::iterator it;
+    for (it = expiredTimerList.begin(); it != expiredTimerList.end(); ++it) {
+        Timer *const currTimer = *it;
+        if (m_eventDispatcherPool) {
+            m_eventDispatcherPool->postEvent(new Event(currTimer, Event::Timeout));
+        } else {
+            currTimer->timeout.emit();
+        }
+    }
+    return nextDeadline;
+}
+
+void EventLoop::postQueuedCall(QueuedCall *queuedCall)
+{
+    if (m_queuedCalls.push(queuedCall)) {
+        wakeUp();
+    }
+}
+
+void EventLoop::processQueuedCalls()
+{
+    QueuedCall *queuedCall = m_queuedCalls.pop();
+    while (queuedCall) {
+        queuedCall->run();
+        delete queuedCall;
+        queuedCall = m_queuedCalls.pop();
+    }
+}
+
+void EventLoop::deleteLater(Object *object)
+{
+    if (object->d->m_pendingDeletion.exchange(true)) {
+        return;
+    }
+    static std::atomic<iint32> nextSegment(0);
+    static __thread iint32 segmentIndex = -1;
+    if (segmentIndex == -1) {
+        segmentIndex = nextSegment.fetch_add(1) % DeletionSegments;
+    }
+    DeletionSegment &segment = m_deletionSegments[segmentIndex];
+    {
+        ContextMutexLocker cml(segment.m_mutex);
+        object->d->m_deletionSegment = &segment;
+        object->d->m_deletionIndex = segment.m_objects.size();
+        segment.m_objects.push_back(object);
+    }
+    if (!m_pendingDeletions.fetch_add(1)) {
+        wakeUp();
+    }
+}
+
+void EventLoop::cancelDeleteLater(Object *object)
+{
+    // The loop could be moving the object to the draining segment meanwhile, so check that it is
+    // still in the segment we locked
+    while (true) {
+        DeletionSegment *const segment = object->d->m_deletionSegment.load();
+        ContextMutexLocker cml(segment->m_mutex);
+        if (segment == object->d->m_deletionSegment.load()) {
+            segment->m_objects[object->d->m_deletionIndex] = 0;
+            return;
+        }
+    }
+}
+
+void EventLoop::processDelayedDeletions()
+{
+    if (!m_pendingDeletions.load()) {
+        return;
+    }
+    // Move everything to the draining segment first, so that objects deleted as a consequence of
+    // deleting others (e.g. children) can still clear their slot
+    iint32 claimed = 0;
+    {
+        ContextMutexLocker drainingCml(m_drainingDeletions.m_mutex);
+        for (iint32 i = 0; i < DeletionSegments; ++i) {
+            DeletionSegment &segment = m_deletionSegments[i];
+            ContextMutexLocker cml(segment.m_mutex);
+            std::vector<Object*>::iterator it;
+            for (it = segment.m_objects.begin(); it != segment.m_objects.end(); ++it) {
+                Object *const object = *it;
+                ++claimed;
+                if (!object) {
+                    continue;
+                }
+                object->d->m_deletionSegment = &m_drainingDeletions;
+                object->d->m_deletionIndex = m_drainingDeletions.m_objects.size();
+                m_drainingDeletions.m_objects.push_back(object);
+            }
+            segment.m_objects.clear();
+        }
+    }
+    m_pendingDeletions.fetch_sub(claimed);
+    const size_t count = m_drainingDeletions.m_objects.size();
+    for (size_t i = 0; i < count; ++i) {
+        Object *object;
+        {
+            ContextMutexLocker cml(m_drainingDeletions.m_mutex);
+            object = m_drainingDeletions.m_objects[i];
+            m_drainingDeletions.m_objects[i] = 0;
+        }
+        delete object;
+    }
+    ContextMutexLocker cml(m_drainingDeletions.m_mutex);
+    m_drainingDeletions.m_objects.clear();
+}
+
+}
@@ -0,0 +1,149 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef EVENT_LOOP_P_H
+#define EVENT_LOOP_P_H
+
+#include <atomic>
+#include <vector>
+
+#include <core/private/timer_heap_p.h>
+#include <core/private/queued_call_queue_p.h>
+
+namespace IdealCore {
+
+class Object;
+class EventDispatcherPool;
+
+/**
+  * A set of objects marked for deletion. Objects remember the segment and the position they were
+  * added at, so that they can clear their slot if they are destroyed before the loop deletes them.
+  */
+struct DeletionSegment
+{
+    Mutex                m_mutex;
+    std::vector<Object*> m_objects;
+};
+
+/**
+  * The loop a thread runs to serve the objects that belong to it: their timers, their queued
+  * calls and their delayed deletions. Application runs one in its main thread, and every
+  * WorkerThread runs its own one, so objects living in different loops never contend on the
+  * same locks.
+  */
+class EventLoop
+{
+public:
+    enum {
+        DeletionSegments = 16
+    };
+
+    /**
+      * If @p eventDispatcherPool is not 0, timeouts are posted to it. Otherwise they are emitted
+      * from the thread running this loop.
+      */
+    EventLoop(EventDispatcherPool *eventDispatcherPool = 0);
+    ~EventLoop();
+
+    /**
+      * Runs until quit() is called.
+      */
+    void exec();
+
+    /**
+      * Makes exec() return. It can be called from any thread, even before exec() is called.
+      */
+    void quit();
+
+    /**
+      * Runs a single iteration: handles expired timers, blocks until there is something to do
+      * and then runs queued calls and delayed deletions.
+      */
+    void processEvents();
+
+    /**
+      * Blocks until there is something to do: @p deadline is reached, a watched descriptor has
+      * events or wakeUp() is called. @p deadline is an absolute time as given by
+      * Timer::monotonicTime(), or -1 if there are no running timers.
+      */
+    void waitForEvents(iint64 deadline);
+
+    /**
+      * Makes the loop return from waitForEvents(). It can be called from any thread.
+      */
+    void wakeUp();
+
+    /**
+      * Delivers a timeout for every expired timer, and reschedules them if needed.
+      *
+      * @return The deadline of the next timer to expire, or -1 if there are no running timers.
+      */
+    iint64 checkTimers();
+
+    /**
+      * Queues @p queuedCall to be run by this loop. It can be called from any thread.
+      */
+    void postQueuedCall(QueuedCall *queuedCall);
+    void processQueuedCalls();
+
+    /**
+      * Marks @p object to be deleted by this loop. It can be called from any thread, and marking
+      * an object that is already marked does nothing.
+      *
+      * Each thread adds objects to its own segment, so threads marking objects at the same time
+      * do not contend on the same mutex.
+      */
+    void deleteLater(Object *object);
+
+    /**
+      * Forgets @p object, that was marked for deletion but is being destroyed before this loop
+      * got to delete it.
+      */
+    void cancelDeleteLater(Object *object);
+
+    /**
+      * Deletes all objects marked for deletion.
+      */
+    void processDelayedDeletions();
+
+#ifdef HAVE_EPOLL
+    void addWatchedDescriptor(iint32 fd);
+    void removeWatchedDescriptor(iint32 fd);
+#endif
+
+    TimerHeap            m_runningTimers;
+    Mutex                m_runningTimersMutex;
+    DeletionSegment      m_deletionSegments[DeletionSegments];
+    DeletionSegment      m_drainingDeletions;
+    std::atomic<iint32>  m_pendingDeletions;
+    QueuedCallQueue      m_queuedCalls;
+    EventDispatcherPool *m_eventDispatcherPool;
+    std::atomic<bool>    m_quit;
+    const iint32         m_defaultSleepTime;
+#ifdef HAVE_EPOLL
+    iint32               m_epoll;
+    iint32               m_wakeUpEvent;
+    iint32               m_timer;
+#endif
+};
+
+}
+
+#endif //EVENT_LOOP_P_H
@@ -0,0 +1,53 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef FUTEX_P_H
+#define FUTEX_P_H
+
+#include <ideal_export.h>
+
+#include <atomic>
+
+namespace IdealCore {
+
+/**
+  * Puts threads to sleep until an integer changes. Where the system does not provide futexes,
+  * they are emulated with a small table of condition variables.
+  */
+class Futex
+{
+public:
+    /**
+      * Sleeps until somebody calls wake() on @p word, as long as @p word is still @p expected.
+      * It can return earlier, for no reason.
+      *
+      * @param ms The maximum time to sleep, in milliseconds. Negative sleeps with no limit.
+      */
+    static void wait(std::atomic<iint32> &word, iint32 expected, iint32 ms = -1);
+
+    /**
+      * Wakes up at most @p count threads sleeping on @p word.
+      */
+    static void wake(std::atomic<iint32> &word, iint32 count);
+};
+
+}
+
+#endif //FUTEX_P_H
@@ -21,6 +21,8 @@
 #ifndef LOCALE_P_H
 #define LOCALE_P_H
 
+#include <core/ref_count.h>
+
 namespace IdealCore {
 
 class Locale::Private
@@ -32,8 +34,8 @@ public:
     void ref();
     void deref();
 
-    size_t  m_refs;
-    Locale *q;
+    RefCount  m_refs;
+    Locale   *q;
 };
 
 }
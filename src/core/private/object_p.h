@@ -21,11 +21,17 @@
 #ifndef OBJECT_P_H
 #define OBJECT_P_H
 
-#include <core/genious_pointer.h>
+#include <atomic>
+
+#include <core/connection.h>
+#include <core/object_pool.h>
+#include <core/read_write_lock.h>
 
 namespace IdealCore {
 
 class Module;
+class EventLoop;
+struct DeletionSegment;
 
 class Object::Private
 {
@@ -33,30 +39,58 @@ public:
     Private(Object *q);
     virtual ~Private();
 
+    static void *operator new(size_t size, ObjectPool *pool)
+    {
+        return ObjectPool::allocate(size, pool);
+    }
+
+    static void operator delete(void *ptr)
+    {
+        ObjectPool::deallocate(ptr);
+    }
+
+    static void operator delete(void *ptr, ObjectPool *pool)
+    {
+        ObjectPool::deallocate(ptr);
+    }
+
     void addChild(Object *child);
     void removeChild(Object *child);
     /**
-      * Recursively add to @p objectList all @p object predecessors. This is used when an object
-      * is deleted, recursively delete all its childs.
+      * Add to @p objectList all @p object predecessors, children before their parents and
+      * @p object last. This is used when an object is deleted, recursively delete all its childs.
+      *
+      * @note Locks of children are taken one at a time, since a child locks its own lock before
+      *       the one of its parent when being reparented or deleted.
       */
     void allPredecessors(Object *object, List<Object*> &objectList);
+    /**
+      * Makes @p object and its descendants allocate the private data of their children from
+      * @p pool. Object pools found on the way, and their descendants, keep their own.
+      */
+    static void setChildrenPool(Object *object, ObjectPool *pool);
     void cleanConnections();
 
+    ReadWriteLock                 m_lock;              ///< Protects m_parent, the child links, m_signals and m_connections
     Object                       *m_parent;
-    Mutex                         m_parentMutex;
-    bool                          m_deleteChildrenRecursively;
-    Mutex                         m_deleteChildrenRecursivelyMutex;
-    bool                          m_blockedSignals;
-    Mutex                         m_blockedSignalsMutex;
-    bool                          m_emitBlocked;
-    Mutex                         m_emitBlockedMutex;
-    List<Object*>                 m_children;
-    Mutex                         m_childrenMutex;
+    std::atomic<bool>             m_deleteChildrenRecursively;
+    std::atomic<bool>             m_blockedSignals;    ///< Stored with release, loaded with acquire
+    std::atomic<bool>             m_emitBlocked;       ///< Stored with release, loaded with acquire
+    Object                       *m_firstChild;
+    Object                       *m_lastChild;
+    Object                       *m_previousSibling;   ///< Protected by the lock of m_parent
+    Object                       *m_nextSibling;       ///< Protected by the lock of m_parent
     List<const SignalBase*>       m_signals;
-    Mutex                         m_signalsMutex;
-    List<GeniousPointer<Object>*> m_connectedObjects;
-    Mutex                         m_connectedObjectsMutex;
+    List<Connection>              m_connections;       ///< Connections this object is the receiver of
+    size_t                        m_connectionsPruneSize; ///< When to drop disconnected handles from m_connections
     Application                  *m_application;
+    EventLoop                    *m_eventLoop;         ///< The event loop this object belongs to
+    EventLoop                    *m_childrenEventLoop; ///< The event loop children of this object will belong to
+    ObjectPool                   *m_childrenPool;      ///< Where the private data of children of this object is allocated
+    std::atomic<ObjectGuard*>     m_guard;             ///< Created when the first GeniousPointer points to this object
+    std::atomic<bool>             m_pendingDeletion;   ///< Whether deleteLater() was called on this object
+    std::atomic<DeletionSegment*> m_deletionSegment;   ///< Where this object is waiting to be deleted
+    size_t                        m_deletionIndex;     ///< Position of this object in m_deletionSegment
     Object                       *q;
 };
 
@@ -0,0 +1,86 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OBJECT_POOL_P_H
+#define OBJECT_POOL_P_H
+
+#include <core/object_pool.h>
+
+#include <vector>
+
+namespace IdealCore {
+
+/**
+  * The arena of a pool. Blocks point back to it, so it is kept alive after the pool is deleted
+  * until the last block allocated from it has been freed.
+  */
+class ObjectPool::Private
+{
+public:
+    enum {
+        Granularity = 32,     ///< Size class i holds blocks of (i + 1) * Granularity bytes
+        SizeClasses = 16,
+        MaxBlockSize = Granularity * SizeClasses,
+        SlabSize = 65536
+    };
+
+    struct FreeBlock
+    {
+        FreeBlock *m_next;
+    };
+
+    /**
+      * Stored right before every block handed out by ObjectPool::allocate(), so it can be freed
+      * without knowing where it came from.
+      */
+    struct alignas(16) BlockHeader
+    {
+        Private *m_arena;     ///< 0 if the block was allocated from the heap
+        size_t   m_sizeClass;
+    };
+
+    Private();
+    ~Private();
+
+    void *allocate(iint32 sizeClass);
+
+    /**
+      * @return Whether the arena has to be deleted, because this was the last allocated block and
+      *         the pool is gone.
+      */
+    bool deallocate(void *ptr, iint32 sizeClass);
+
+    /**
+      * @return Whether the arena has to be deleted, because there are no allocated blocks left.
+      */
+    bool poolDestroyed();
+
+    Mutex               m_mutex;
+    FreeBlock          *m_freeLists[SizeClasses];
+    std::vector<ichar*> m_slabs;
+    ichar              *m_slabCursor;      ///< Where the next block of the last slab starts
+    ichar              *m_slabEnd;
+    size_t              m_allocatedBlocks;
+    bool                m_poolDestroyed;
+};
+
+}
+
+#endif //OBJECT_POOL_P_H
@@ -29,6 +29,8 @@
 #include <map>
 
 #include <core/file.h>
+#include <core/timer.h>
+#include <core/context_read_locker.h>
 
 #include <core/application.h>
 #include "application_p.h"
@@ -286,16 +288,29 @@ void Application::Private::checkFileWatches()
 {
 #ifdef HAVE_INOTIFY
     PrivateImpl *const d_i = static_cast<PrivateImpl*>(this);
-    if (d_i->m_inotifyStarted) {
+    List<PrivateImpl::InotifyEvent> inotifyEventList;
+    {
+        // Files are only looked up here, so this does not wait for other threads reading the map.
+        // Signals are emitted once the lock has been released, only for the files that were not
+        // destroyed in between
+        ContextReadLocker crl(d_i->m_inotifyLock);
+        if (!d_i->m_inotifyStarted) {
+            return;
+        }
         ichar buf[BUF_LEN];
         iint32 len = 0;
         iint32 i = 0;
         len = read(d_i->m_inotify, buf, BUF_LEN);
         if (len >= 0) {
-            List<PrivateImpl::InotifyEvent> inotifyEventList;
             while (i < len) {
                 struct inotify_event *const event = (struct inotify_event*) &buf[i];
-                File *const file = d_i->m_inotifyMap[event->wd];
+                const std::map<int, File*>::const_iterator watch = d_i->m_inotifyMap.find(event->wd);
+                if (watch == d_i->m_inotifyMap.end()) {
+                    // The file stopped being watched after the event was queued
+                    i += EVENT_SIZE + event->len;
+                    continue;
+                }
+                File *const file = watch->second;
                 File::EventNotify eventNotify;
                 eventNotify.event = File::NoEvent;
                 if (event->mask & IN_ACCESS) {
@@ -327,19 +342,21 @@ void Application::Private::checkFileWatches()
                 } else {
                     eventNotify.uri = file->uri();
                 }
-                PrivateImpl::InotifyEvent inotifyEvent;
-                inotifyEvent.file = file;
+                PrivateImpl::InotifyEvent inotifyEvent(file);
                 inotifyEvent.eventNotify = eventNotify;
                 inotifyEventList.push_back(inotifyEvent);
                 i += EVENT_SIZE + event->len;
             }
-            List<PrivateImpl::InotifyEvent>::const_iterator it;
-            for (it = inotifyEventList.begin(); it != inotifyEventList.end(); ++it) {
-                PrivateImpl::InotifyEvent inotifyEvent = *it;
-                inotifyEvent.file->event.emit(inotifyEvent.eventNotify);
-            }
         }
     }
+    List<PrivateImpl::InotifyEvent>::const_iterator it;
+    for (it = inotifyEventList.begin(); it != inotifyEventList.end(); ++it) {
+        const PrivateImpl::InotifyEvent &inotifyEvent = *it;
+        if (inotifyEvent.file.isContentDestroyed()) {
+            continue;
+        }
+        inotifyEvent.file->event.emit(inotifyEvent.eventNotify);
+    }
 #endif
 }
 
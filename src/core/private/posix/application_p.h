@@ -25,6 +25,8 @@
 #include <getopt.h>
 
 #include <core/file.h>
+#include <core/genious_pointer.h>
+#include <core/read_write_lock.h>
 
 #include <core/private/application_p.h>
 
@@ -44,12 +46,18 @@ public:
     };
 
     struct InotifyEvent {
-        File             *file;
-        File::EventNotify eventNotify;
+        InotifyEvent(File *file)
+            : file(file)
+        {
+        }
+
+        GeniousPointer<File> file;        ///< Taken with m_inotifyLock locked, so file is alive
+        File::EventNotify    eventNotify;
     };
 
     List<OptionItem>     m_optionList;
 #ifdef HAVE_INOTIFY
+    ReadWriteLock        m_inotifyLock;    ///< Protects m_inotifyStarted, m_inotify and m_inotifyMap
     bool                 m_inotifyStarted;
     iint32               m_inotify;
     std::map<int, File*> m_inotifyMap;
@@ -18,53 +18,52 @@
  * Boston, MA 02110-1301, USA.
  */
 
-#include <sys/time.h>
-
 #include <core/cond_var.h>
 #include "cond_var_p.h"
-#include "mutex_p.h"
+#include <core/private/futex_p.h>
+
+#include <limits.h>
 
 namespace IdealCore {
 
 CondVar::PrivateImpl::PrivateImpl(Mutex &mutex)
     : Private(mutex)
+    , m_sequence(0)
 {
-    pthread_cond_init(&m_cond, 0);
 }
 
 CondVar::PrivateImpl::~PrivateImpl()
 {
-    pthread_cond_destroy(&m_cond);
 }
 
 void CondVar::wait()
 {
-    pthread_cond_wait(&D_I->m_cond, &static_cast<Mutex::PrivateImpl*>(d->m_mutex.d)->m_mutex);
+    // Reading the sequence before unlocking means a signal() sent after the unlock makes
+    // Futex::wait() return right away, instead of being lost
+    const iint32 sequence = D_I->m_sequence.load(std::memory_order_acquire);
+    const iint32 recursion = d->m_mutex.release();
+    Futex::wait(D_I->m_sequence, sequence);
+    d->m_mutex.reacquire(recursion);
 }
 
 void CondVar::timedWait(iint32 ms)
 {
-    struct timeval curr;
-    gettimeofday(&curr, 0);
-    struct timespec timeout;
-    timeout.tv_sec = curr.tv_sec + ms / 1000;
-    timeout.tv_nsec = curr.tv_usec * 1000 + (ms % 1000) * 1000000;
-    if (timeout.tv_nsec >= 1000000000) {
-        ++timeout.tv_sec;
-        timeout.tv_nsec -= 1000000000;
-    }
-    pthread_cond_timedwait(&D_I->m_cond, &static_cast<Mutex::PrivateImpl*>(d->m_mutex.d)->m_mutex, &timeout);
+    const iint32 sequence = D_I->m_sequence.load(std::memory_order_acquire);
+    const iint32 recursion = d->m_mutex.release();
+    Futex::wait(D_I->m_sequence, sequence, ms);
+    d->m_mutex.reacquire(recursion);
 }
 
 void CondVar::signal()
 {
-    pthread_cond_signal(&D_I->m_cond);
+    D_I->m_sequence.fetch_add(1, std::memory_order_release);
+    Futex::wake(D_I->m_sequence, 1);
 }
 
 void CondVar::broadcast()
 {
-    pthread_cond_broadcast(&D_I->m_cond);
+    D_I->m_sequence.fetch_add(1, std::memory_order_release);
+    Futex::wake(D_I->m_sequence, INT_MAX);
 }
 
 }
-
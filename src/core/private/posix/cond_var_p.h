@@ -21,7 +21,7 @@
 #ifndef COND_VAR_P_H_POSIX
 #define COND_VAR_P_H_POSIX
 
-#include <pthread.h>
+#include <atomic>
 
 #include <core/private/cond_var_p.h>
 
@@ -34,7 +34,7 @@ public:
     PrivateImpl(Mutex &mutex);
     virtual ~PrivateImpl();
 
-    pthread_cond_t m_cond;
+    std::atomic<iint32> m_sequence; ///< Bumped by every signal() and broadcast()
 };
 
 }
@@ -0,0 +1,118 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+#include <unistd.h>
+
+#include <core/timer.h>
+#include <core/private/event_loop_p.h>
+
+#ifdef HAVE_EPOLL
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#endif
+
+namespace IdealCore {
+
+EventLoop::EventLoop(EventDispatcherPool *eventDispatcherPool)
+    : m_pendingDeletions(0)
+    , m_eventDispatcherPool(eventDispatcherPool)
+    , m_quit(false)
+    , m_defaultSleepTime(500)
+{
+#ifdef HAVE_EPOLL
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeUpEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    addWatchedDescriptor(m_wakeUpEvent);
+    addWatchedDescriptor(m_timer);
+#endif
+}
+
+EventLoop::~EventLoop()
+{
+#ifdef HAVE_EPOLL
+    close(m_timer);
+    close(m_wakeUpEvent);
+    close(m_epoll);
+#endif
+}
+
+#ifdef HAVE_EPOLL
+void EventLoop::addWatchedDescriptor(iint32 fd)
+{
+    struct epoll_event event;
+    memset(&event, 0, sizeof(struct epoll_event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event);
+}
+
+void EventLoop::removeWatchedDescriptor(iint32 fd)
+{
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, 0);
+}
+#endif
+
+void EventLoop::waitForEvents(iint64 deadline)
+{
+#ifdef HAVE_EPOLL
+    // An all-zero itimerspec disarms the timer, what is what we want if there are no timers running.
+    // Otherwise, it is armed with an absolute deadline, so it does not matter how long it took us
+    // to get here since the last timer check.
+    struct itimerspec expiration;
+    memset(&expiration, 0, sizeof(struct itimerspec));
+    if (deadline >= 0) {
+        expiration.it_value.tv_sec = deadline / 1000000000;
+        expiration.it_value.tv_nsec = deadline % 1000000000;
+    }
+    timerfd_settime(m_timer, TFD_TIMER_ABSTIME, &expiration, 0);
+    struct epoll_event events[3];
+    const iint32 numEvents = epoll_wait(m_epoll, events, 3, -1);
+    for (iint32 i = 0; i < numEvents; ++i) {
+        const iint32 fd = events[i].data.fd;
+        if (fd == m_wakeUpEvent || fd == m_timer) {
+            uint64_t counter;
+            if (read(fd, &counter, sizeof(uint64_t))) {}
+        }
+    }
+#else
+    iint32 msec = m_defaultSleepTime;
+    if (deadline >= 0) {
+        const iint64 remaining = (deadline - Timer::monotonicTime()) / 1000000;
+        if (remaining < msec) {
+            msec = remaining > 0 ? remaining : 0;
+        }
+    }
+    Timer::wait(msec);
+#endif
+}
+
+void EventLoop::wakeUp()
+{
+#ifdef HAVE_EPOLL
+    const uint64_t counter = 1;
+    if (write(m_wakeUpEvent, &counter, sizeof(uint64_t))) {}
+#endif
+}
+
+}
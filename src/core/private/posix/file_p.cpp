@@ -22,6 +22,7 @@
 #include "file_p.h"
 #include <core/application.h>
 #include "application_p.h"
+#include <core/context_write_locker.h>
 #include <unistd.h>
 
 #ifdef HAVE_INOTIFY
@@ -40,10 +41,14 @@ File::PrivateImpl::~PrivateImpl()
 #ifdef HAVE_INOTIFY
     if (m_events != NoEvent) {
         Application::PrivateImpl *app_d = static_cast<Application::PrivateImpl*>(q->application()->d);
+        ContextWriteLocker cwl(app_d->m_inotifyLock);
         inotify_rm_watch(app_d->m_inotify, m_inotifyWatch);
         app_d->m_inotifyMap.erase(m_inotifyWatch);
         if (!app_d->m_inotifyMap.size()) {
             app_d->m_inotifyStarted = false;
+#ifdef HAVE_EPOLL
+            app_d->m_eventLoop.removeWatchedDescriptor(app_d->m_inotify);
+#endif
             close(app_d->m_inotify);
         }
     }
@@ -57,9 +62,13 @@ void File::setTrackEvents(Event events)
         return;
     }
     Application::PrivateImpl *app_d = static_cast<Application::PrivateImpl*>(application()->d);
+    ContextWriteLocker cwl(app_d->m_inotifyLock);
     if (!app_d->m_inotifyStarted) {
         if ((app_d->m_inotify = inotify_init1(IN_NONBLOCK)) > -1) {
             app_d->m_inotifyStarted = true;
+#ifdef HAVE_EPOLL
+            app_d->m_eventLoop.addWatchedDescriptor(app_d->m_inotify);
+#endif
         }
     }
     if (app_d->m_inotifyStarted) {
@@ -96,6 +105,9 @@ void File::setTrackEvents(Event events)
             app_d->m_inotifyMap.erase(D_I->m_inotifyWatch);
             if (!app_d->m_inotifyMap.size()) {
                 app_d->m_inotifyStarted = false;
+#ifdef HAVE_EPOLL
+                app_d->m_eventLoop.removeWatchedDescriptor(app_d->m_inotify);
+#endif
                 close(app_d->m_inotify);
             }
         }
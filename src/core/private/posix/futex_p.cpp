@@ -0,0 +1,120 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <core/private/futex_p.h>
+
+#ifdef HAVE_FUTEX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/time.h>
+#endif
+
+namespace IdealCore {
+
+#ifdef HAVE_FUTEX
+
+void Futex::wait(std::atomic<iint32> &word, iint32 expected, iint32 ms)
+{
+    struct timespec timeout;
+    struct timespec *timeoutPtr = 0;
+    if (ms >= 0) {
+        timeout.tv_sec = ms / 1000;
+        timeout.tv_nsec = (ms % 1000) * 1000000;
+        timeoutPtr = &timeout;
+    }
+    syscall(SYS_futex, reinterpret_cast<iint32*>(&word), FUTEX_WAIT_PRIVATE, expected, timeoutPtr, 0, 0);
+}
+
+void Futex::wake(std::atomic<iint32> &word, iint32 count)
+{
+    syscall(SYS_futex, reinterpret_cast<iint32*>(&word), FUTEX_WAKE_PRIVATE, count, 0, 0, 0);
+}
+
+#else
+
+namespace {
+
+enum {
+    Buckets = 64
+};
+
+/**
+  * Threads waiting on words whose address falls in this bucket. Waking up wakes all of them, and
+  * the ones waiting on other words go back to sleep.
+  */
+struct Bucket
+{
+    Bucket()
+    {
+        pthread_mutex_init(&m_mutex, 0);
+        pthread_cond_init(&m_cond, 0);
+    }
+
+    pthread_mutex_t m_mutex;
+    pthread_cond_t  m_cond;
+};
+
+Bucket &bucket(std::atomic<iint32> &word)
+{
+    static Bucket *const buckets = new Bucket[Buckets];
+    return buckets[(reinterpret_cast<uintptr_t>(&word) / sizeof(iint32)) % Buckets];
+}
+
+}
+
+void Futex::wait(std::atomic<iint32> &word, iint32 expected, iint32 ms)
+{
+    Bucket &b = bucket(word);
+    pthread_mutex_lock(&b.m_mutex);
+    if (word.load() == expected) {
+        if (ms < 0) {
+            pthread_cond_wait(&b.m_cond, &b.m_mutex);
+        } else {
+            struct timeval curr;
+            gettimeofday(&curr, 0);
+            struct timespec timeout;
+            timeout.tv_sec = curr.tv_sec + ms / 1000;
+            timeout.tv_nsec = curr.tv_usec * 1000 + (ms % 1000) * 1000000;
+            if (timeout.tv_nsec >= 1000000000) {
+                ++timeout.tv_sec;
+                timeout.tv_nsec -= 1000000000;
+            }
+            pthread_cond_timedwait(&b.m_cond, &b.m_mutex, &timeout);
+        }
+    }
+    pthread_mutex_unlock(&b.m_mutex);
+}
+
+void Futex::wake(std::atomic<iint32> &word, iint32 count)
+{
+    Bucket &b = bucket(word);
+    pthread_mutex_lock(&b.m_mutex);
+    pthread_cond_broadcast(&b.m_cond);
+    pthread_mutex_unlock(&b.m_mutex);
+}
+
+#endif
+
+}
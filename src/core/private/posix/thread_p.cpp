@@ -20,11 +20,59 @@
 
 #include <core/thread.h>
 #include "thread_p.h"
+#include <core/cond_var.h>
+#include <core/timer.h>
+#include <core/private/futex_p.h>
+
+#include <limits.h>
 
 namespace IdealCore {
 
+namespace {
+
+enum {
+    IdleTimeout = 10000, ///< Milliseconds a thread of the pool waits for work before exiting
+    MaxThreads  = 64     ///< Maximum number of threads kept by the pool
+};
+
+/**
+  * Threads kept around to run pooled Thread objects. It grows whenever no thread is idle, since
+  * pooled threads can block waiting for each other the same way regular ones do. Once it has
+  * MaxThreads threads, pooled Thread objects that find no idle thread get a dedicated one, that
+  * exits when run() returns.
+  */
+struct ThreadPool
+{
+    ThreadPool()
+        : m_workAvailable(m_mutex)
+        , m_threads(0)
+        , m_idleThreads(0)
+    {
+        pthread_attr_init(&m_attr);
+        pthread_attr_setdetachstate(&m_attr, PTHREAD_CREATE_DETACHED);
+    }
+
+    Mutex          m_mutex;
+    CondVar        m_workAvailable;
+    List<Thread*>  m_queue;
+    iint32         m_threads;
+    size_t         m_idleThreads;
+    pthread_attr_t m_attr;
+};
+
+ThreadPool &threadPool()
+{
+    // Never deleted, threads of the pool can outlive static destruction
+    static ThreadPool *const pool = new ThreadPool;
+    return *pool;
+}
+
+}
+
 Thread::PrivateImpl::PrivateImpl(Type type)
     : Private(type)
+    , m_running(0)
+    , m_created(false)
 {
     pthread_attr_init(&m_attr);
     if (type == NoJoinable) {
@@ -43,23 +91,111 @@ void *Thread::PrivateImpl::entryPoint(void *param)
     thread->run();
     if (thread->d->m_type == NoJoinable) {
         delete thread;
+    } else if (thread->d->m_pooled) {
+        // join() can delete the thread as soon as m_running is cleared. Waking up only needs the
+        // address, not the object
+        std::atomic<iint32> &running = static_cast<PrivateImpl*>(thread->d)->m_running;
+        running.store(0, std::memory_order_release);
+        Futex::wake(running, INT_MAX);
     }
     return 0;
 }
 
+void Thread::PrivateImpl::schedule(Thread *thread)
+{
+    ThreadPool &pool = threadPool();
+    {
+        ContextMutexLocker cml(pool.m_mutex);
+        pool.m_queue.push_back(thread);
+        // Idle threads that were already woken up but did not pick their thread yet are still
+        // counted
+        if (pool.m_idleThreads >= pool.m_queue.size()) {
+            pool.m_workAvailable.signal();
+            return;
+        }
+        if (pool.m_threads < MaxThreads) {
+            pthread_t poolThread;
+            if (!pthread_create(&poolThread, &pool.m_attr, poolEntryPoint, 0)) {
+                ++pool.m_threads;
+                return;
+            }
+        }
+        // m_mutex was held all along, so no thread of the pool could have taken it
+        pool.m_queue.pop_back();
+    }
+    pthread_t dedicatedThread;
+    if (pthread_create(&dedicatedThread, &pool.m_attr, entryPoint, thread)) {
+        IDEAL_DEBUG_WARNING("it was not possible to create a thread");
+        // run() will never be called. NoJoinable threads would have deleted themselves afterwards,
+        // and join() must not wait for it
+        if (thread->d->m_type == NoJoinable) {
+            delete thread;
+            return;
+        }
+        std::atomic<iint32> &running = static_cast<PrivateImpl*>(thread->d)->m_running;
+        running.store(0, std::memory_order_release);
+        Futex::wake(running, INT_MAX);
+    }
+}
+
+void *Thread::PrivateImpl::poolEntryPoint(void *)
+{
+    ThreadPool &pool = threadPool();
+    while (true) {
+        Thread *thread;
+        {
+            ContextMutexLocker cml(pool.m_mutex);
+            const iint64 deadline = Timer::monotonicTime() + IdleTimeout * 1000000LL;
+            ++pool.m_idleThreads;
+            while (pool.m_queue.empty()) {
+                const iint64 remaining = (deadline - Timer::monotonicTime()) / 1000000;
+                if (remaining <= 0) {
+                    --pool.m_idleThreads;
+                    --pool.m_threads;
+                    return 0;
+                }
+                pool.m_workAvailable.timedWait(remaining);
+            }
+            --pool.m_idleThreads;
+            thread = pool.m_queue.front();
+            pool.m_queue.pop_front();
+        }
+        entryPoint(thread);
+    }
+}
+
 void Thread::exec()
 {
-    pthread_create(&D_I->m_thread, &D_I->m_attr, PrivateImpl::entryPoint, this);
+    if (d->m_pooled) {
+        D_I->m_running.store(1, std::memory_order_relaxed);
+        PrivateImpl::schedule(this);
+        return;
+    }
+    D_I->m_created = !pthread_create(&D_I->m_thread, &D_I->m_attr, PrivateImpl::entryPoint, this);
+    if (!D_I->m_created) {
+        IDEAL_DEBUG_WARNING("it was not possible to create a thread");
+        if (d->m_type == NoJoinable) {
+            delete this;
+        }
+    }
 }
 
 void Thread::join()
 {
     if (d->m_type == Joinable) {
-        pthread_join(D_I->m_thread, NULL);
+        if (d->m_pooled) {
+            while (D_I->m_running.load(std::memory_order_acquire)) {
+                Futex::wait(D_I->m_running, 1);
+            }
+            return;
+        }
+        if (D_I->m_created) {
+            pthread_join(D_I->m_thread, NULL);
+            D_I->m_created = false;
+        }
     } else {
         IDEAL_DEBUG_WARNING("join() has been called in a Thread object with attribute NoJoinable");
     }
 }
 
 }
-
@@ -21,6 +21,7 @@
 #ifndef THREAD_P_H_POSIX
 #define THREAD_P_H_POSIX
 
+#include <atomic>
 #include <pthread.h>
 #include <core/private/thread_p.h>
 
@@ -35,9 +36,18 @@ public:
 
     static void *entryPoint(void *param);
 
-    pthread_t          m_thread;
-    pthread_attr_t     m_attr;
-    struct sched_param m_schedParam;
+    /**
+      * Queues @p thread to be run by an idle thread of the pool, creating a new one if all of them
+      * are busy.
+      */
+    static void schedule(Thread *thread);
+    static void *poolEntryPoint(void *param);
+
+    pthread_t           m_thread;
+    pthread_attr_t      m_attr;
+    struct sched_param  m_schedParam;
+    std::atomic<iint32> m_running;    ///< Whether run() is being called from the pool, for join()
+    bool                m_created;    ///< Whether m_thread was created by the last exec(), for join()
 };
 
 }
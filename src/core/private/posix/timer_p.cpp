@@ -18,6 +18,7 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <time.h>
 #include <sys/time.h>
 
 #include <core/timer.h>
@@ -42,4 +43,11 @@ void Timer::timedWait(iint32 ms) const
     nanosleep(&tw, 0);
 }
 
+iint64 Timer::monotonicTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (iint64) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
 }
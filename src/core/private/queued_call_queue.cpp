@@ -0,0 +1,107 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "queued_call_queue_p.h"
+
+#include <sched.h>
+
+namespace IdealCore {
+
+QueuedCallQueue::Stub::Stub()
+    : QueuedCall(0)
+{
+}
+
+void QueuedCallQueue::Stub::call()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+QueuedCallQueue::QueuedCallQueue()
+    : m_head(&m_stub)
+    , m_tail(&m_stub)
+    , m_size(0)
+{
+}
+
+QueuedCallQueue::~QueuedCallQueue()
+{
+    QueuedCall *queuedCall = pop();
+    while (queuedCall) {
+        delete queuedCall;
+        queuedCall = pop();
+    }
+}
+
+bool QueuedCallQueue::push(QueuedCall *queuedCall)
+{
+    append(queuedCall);
+    return m_size.fetch_add(1) == 0;
+}
+
+QueuedCall *QueuedCallQueue::pop()
+{
+    IDEAL_FOREVER {
+        QueuedCall *tail = m_tail;
+        QueuedCall *next = tail->m_next.load(std::memory_order_acquire);
+        if (tail == &m_stub) {
+            if (!next) {
+                if (m_head.load(std::memory_order_acquire) == &m_stub) {
+                    return 0;
+                }
+                // A producer has published a call but did not link it yet
+                sched_yield();
+                continue;
+            }
+            m_tail = next;
+            tail = next;
+            next = next->m_next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            m_tail = next;
+            m_size.fetch_sub(1);
+            return tail;
+        }
+        if (tail != m_head.load(std::memory_order_acquire)) {
+            // A producer has published a call after tail but did not link it yet
+            sched_yield();
+            continue;
+        }
+        // tail is the last call. Push the stub behind it so it can be unlinked from the queue.
+        append(&m_stub);
+        next = tail->m_next.load(std::memory_order_acquire);
+        if (next) {
+            m_tail = next;
+            m_size.fetch_sub(1);
+            return tail;
+        }
+        sched_yield();
+    }
+}
+
+void QueuedCallQueue::append(QueuedCall *queuedCall)
+{
+    queuedCall->m_next.store(0, std::memory_order_relaxed);
+    QueuedCall *const prev = m_head.exchange(queuedCall, std::memory_order_acq_rel);
+    prev->m_next.store(queuedCall, std::memory_order_release);
+}
+
+}
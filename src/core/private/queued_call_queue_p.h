@@ -0,0 +1,78 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef QUEUED_CALL_QUEUE_P_H
+#define QUEUED_CALL_QUEUE_P_H
+
+#include <atomic>
+
+#include <core/object.h>
+
+namespace IdealCore {
+
+/**
+  * A lock-free, intrusive, multiple producer single consumer FIFO of queued calls. Any thread can
+  * push() without ever blocking, while only the thread running the event loop can pop().
+  *
+  * Producers only exchange the head pointer and then link the previous head to the new call, so
+  * there is a short window in which a call is published but not reachable yet. pop() waits for
+  * the producer to finish in that case, which is only a couple of instructions away.
+  */
+class QueuedCallQueue
+{
+public:
+    QueuedCallQueue();
+    ~QueuedCallQueue();
+
+    /**
+      * Appends @p queuedCall to the queue. It can be called from any thread.
+      *
+      * @return Whether the queue was empty, and the consumer has to be woken up.
+      */
+    bool push(QueuedCall *queuedCall);
+
+    /**
+      * @return The oldest call in the queue, or 0 if it is empty. Only the consumer thread can
+      *         call this method.
+      */
+    QueuedCall *pop();
+
+private:
+    class Stub
+        : public QueuedCall
+    {
+    public:
+        Stub();
+
+    protected:
+        virtual void call();
+    };
+
+    void append(QueuedCall *queuedCall);
+
+    std::atomic<QueuedCall*> m_head;
+    QueuedCall              *m_tail;
+    std::atomic<iint32>      m_size;
+    Stub                     m_stub;
+};
+
+}
+
+#endif //QUEUED_CALL_QUEUE_P_H
@@ -32,6 +32,7 @@ public:
     virtual ~Private();
 
     Type m_type;
+    bool m_pooled;
 };
 
 }
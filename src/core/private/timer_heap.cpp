@@ -0,0 +1,120 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "timer_heap_p.h"
+#include "timer_p.h"
+
+namespace IdealCore {
+
+bool TimerHeap::empty() const
+{
+    return m_heap.empty();
+}
+
+size_t TimerHeap::size() const
+{
+    return m_heap.size();
+}
+
+Timer *TimerHeap::top() const
+{
+    return m_heap.front();
+}
+
+void TimerHeap::push(Timer *timer)
+{
+    timer->d->m_heapIndex = m_heap.size();
+    m_heap.push_back(timer);
+    siftUp(m_heap.size() - 1);
+}
+
+void TimerHeap::remove(Timer *timer)
+{
+    const size_t index = timer->d->m_heapIndex;
+    if (index == NotInHeap) {
+        return;
+    }
+    const size_t last = m_heap.size() - 1;
+    if (index != last) {
+        swap(index, last);
+    }
+    m_heap.pop_back();
+    timer->d->m_heapIndex = NotInHeap;
+    if (index != last) {
+        siftUp(index);
+        siftDown(index);
+    }
+}
+
+Timer *TimerHeap::pop()
+{
+    Timer *const timer = m_heap.front();
+    remove(timer);
+    return timer;
+}
+
+bool TimerHeap::lessThan(size_t left, size_t right) const
+{
+    return m_heap[left]->d->m_deadline < m_heap[right]->d->m_deadline;
+}
+
+void TimerHeap::swap(size_t left, size_t right)
+{
+    Timer *const timer = m_heap[left];
+    m_heap[left] = m_heap[right];
+    m_heap[right] = timer;
+    m_heap[left]->d->m_heapIndex = left;
+    m_heap[right]->d->m_heapIndex = right;
+}
+
+void TimerHeap::siftUp(size_t index)
+{
+    while (index) {
+        const size_t parent = (index - 1) / 2;
+        if (!lessThan(index, parent)) {
+            break;
+        }
+        swap(index, parent);
+        index = parent;
+    }
+}
+
+void TimerHeap::siftDown(size_t index)
+{
+    const size_t size = m_heap.size();
+    while (true) {
+        const size_t left = 2 * index + 1;
+        const size_t right = left + 1;
+        size_t smallest = index;
+        if (left < size && lessThan(left, smallest)) {
+            smallest = left;
+        }
+        if (right < size && lessThan(right, smallest)) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        swap(index, smallest);
+        index = smallest;
+    }
+}
+
+}
@@ -0,0 +1,63 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef TIMER_HEAP_P_H
+#define TIMER_HEAP_P_H
+
+#include <vector>
+
+#include <core/timer.h>
+
+namespace IdealCore {
+
+/**
+  * A binary min-heap of running timers ordered by deadline. Each timer knows its own position in
+  * the heap, so insertion and removal of any timer are O(log n), and looking up the next timer to
+  * expire is O(1).
+  */
+class TimerHeap
+{
+public:
+    static const size_t NotInHeap = (size_t) -1;
+
+    bool empty() const;
+    size_t size() const;
+
+    /**
+      * @return The timer with the earliest deadline.
+      */
+    Timer *top() const;
+
+    void push(Timer *timer);
+    void remove(Timer *timer);
+    Timer *pop();
+
+private:
+    bool lessThan(size_t left, size_t right) const;
+    void swap(size_t left, size_t right);
+    void siftUp(size_t index);
+    void siftDown(size_t index);
+
+    std::vector<Timer*> m_heap;
+};
+
+}
+
+#endif //TIMER_HEAP_P_H
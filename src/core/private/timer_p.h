@@ -29,13 +29,19 @@ public:
     Private(Timer *q);
     virtual ~Private();
 
-    bool listContains() const;
-
-    TimeoutType m_timeoutType;
-    iint32      m_interval;
-    iint32      m_remaining;
-    State       m_state;
-    Timer      *q;
+    /**
+      * Computes the next deadline of a periodic timer that expired at @p now. If whole periods
+      * were missed they are skipped, keeping the timer in phase with its original deadline.
+      */
+    void reschedule(iint64 now);
+
+    TimeoutType   m_timeoutType;
+    iint64        m_interval;      ///< Interval in nanoseconds
+    iint64        m_deadline;      ///< Absolute expiration time, as given by Timer::monotonicTime()
+    size_t        m_heapIndex;     ///< Position in the running timers heap
+    LatenessStats m_latenessStats; ///< Protected by the running timers mutex of the application
+    State         m_state;
+    Timer        *q;
 };
 
 }
@@ -18,31 +18,20 @@
  * Boston, MA 02110-1301, USA.
  */
 
-#ifndef MUTEX_P_H
-#define MUTEX_P_H
+#ifndef WORKER_THREAD_P_H
+#define WORKER_THREAD_P_H
 
-#include <core/mutex.h>
+#include <core/worker_thread.h>
+#include <core/private/event_loop_p.h>
 
 namespace IdealCore {
 
-class Mutex::Private
+class WorkerThread::Private
 {
 public:
-    Private();
-    virtual ~Private();
-
-    void ref();
-    void deref();
-
-private:
-    size_t m_refs;
+    EventLoop m_eventLoop;
 };
 
 }
 
-#ifdef IDEAL_OS_POSIX
-#include <core/private/posix/mutex_p.h>
-#endif //IDEAL_OS_POSIX
-
-#endif //MUTEX_P_H
-
+#endif //WORKER_THREAD_P_H
@@ -0,0 +1,91 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "read_write_lock.h"
+#include "private/futex_p.h"
+
+#include <limits.h>
+
+namespace IdealCore {
+
+#ifdef IDEAL_MUTEX_PROFILING
+ReadWriteLock::ReadWriteLock(const ichar *file, iint32 line)
+    : m_state(0)
+    , m_writersMutex(Mutex::NoRecursive, file, line)
+{
+}
+#else
+ReadWriteLock::ReadWriteLock()
+    : m_state(0)
+{
+}
+#endif
+
+ReadWriteLock::~ReadWriteLock()
+{
+}
+
+void ReadWriteLock::lockForReadSlow()
+{
+    // lockForRead() counted us as a reader anyway. Leaving works the same as unlocking, waking up
+    // the writer if we were the last one it was waiting for
+    unlockForRead();
+    IDEAL_FOREVER {
+        iint32 state = m_state.load(std::memory_order_relaxed);
+        if (!(state & Writer)) {
+            if (m_state.compare_exchange_weak(state, state + 1, std::memory_order_acquire)) {
+                return;
+            }
+            continue;
+        }
+        if (!(state & Sleepers) &&
+            !m_state.compare_exchange_weak(state, state | Sleepers, std::memory_order_relaxed)) {
+            continue;
+        }
+        Futex::wait(m_state, state | Sleepers);
+    }
+}
+
+void ReadWriteLock::waitForReaders()
+{
+    // Readers cannot come in anymore, since the Writer bit is set. We only need to wait for the
+    // ones that were already in to leave, the last one will wake us up
+    IDEAL_FOREVER {
+        iint32 state = m_state.load(std::memory_order_acquire);
+        if (!(state & ReadersMask)) {
+            return;
+        }
+        if (!(state & Sleepers) &&
+            !m_state.compare_exchange_weak(state, state | Sleepers, std::memory_order_relaxed)) {
+            continue;
+        }
+        Futex::wait(m_state, state | Sleepers);
+    }
+}
+
+void ReadWriteLock::wakeAll()
+{
+    // Readers waiting for the writer to finish, and the writer waiting for readers, all sleep on
+    // m_state. The ones that woke up for nothing will set Sleepers again and go back to sleep
+    m_state.fetch_and(~Sleepers, std::memory_order_relaxed);
+    Futex::wake(m_state, INT_MAX);
+}
+
+}
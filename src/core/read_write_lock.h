@@ -0,0 +1,132 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef READ_WRITE_LOCK_H
+#define READ_WRITE_LOCK_H
+
+#include <ideal_export.h>
+
+#include <atomic>
+
+#include <core/mutex.h>
+
+namespace IdealCore {
+
+/**
+  * @class ReadWriteLock read_write_lock.h core/read_write_lock.h
+  *
+  * Protects state that is read much more often than it is modified. Any number of threads can
+  * hold it for reading at the same time, while only one thread can hold it for writing, and
+  * nobody can hold it for reading meanwhile.
+  *
+  * Taking it for reading when nobody is writing is a single atomic operation on the lock, done
+  * inline. Writers are preferred: once a writer is waiting, new readers wait until it is done, so
+  * writers cannot be starved by a continuous stream of readers.
+  *
+  * @note It is not recursive. Taking it for reading twice from the same thread can deadlock if a
+  *       writer arrives between both.
+  *
+  * @see ContextReadLocker
+  * @see ContextWriteLocker
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class IDEAL_EXPORT ReadWriteLock
+{
+public:
+#ifdef IDEAL_MUTEX_PROFILING
+    /**
+      * Writers are accounted to the place this lock was created at, as if it was a Mutex.
+      */
+    ReadWriteLock(const ichar *file = __builtin_FILE(), iint32 line = __builtin_LINE());
+#else
+    ReadWriteLock();
+#endif
+    ~ReadWriteLock();
+
+    /**
+      * Locks this lock for reading. If a writer holds it or is waiting for it we wait until it
+      * unlocks.
+      */
+    void lockForRead()
+    {
+        // Counting ourselves as a reader before checking saves a compare-and-swap loop. If a
+        // writer is there, lockForReadSlow() takes us out again
+        if (IDEAL_LIKELY(!(m_state.fetch_add(1, std::memory_order_acquire) & ~ReadersMask))) {
+            return;
+        }
+        lockForReadSlow();
+    }
+
+    /**
+      * Locks this lock for writing. If other writer or any reader holds it we wait until they
+      * unlock.
+      */
+    void lockForWrite()
+    {
+        m_writersMutex.lock();
+        if (IDEAL_UNLIKELY(m_state.fetch_or(Writer, std::memory_order_acquire) & ReadersMask)) {
+            waitForReaders();
+        }
+    }
+
+    /**
+      * Unlocks this lock, previously locked with lockForRead().
+      */
+    void unlockForRead()
+    {
+        const iint32 state = m_state.fetch_sub(1, std::memory_order_release) - 1;
+        if (IDEAL_UNLIKELY(state == (Writer | Sleepers))) {
+            wakeAll();
+        }
+    }
+
+    /**
+      * Unlocks this lock, previously locked with lockForWrite().
+      */
+    void unlockForWrite()
+    {
+        if (IDEAL_UNLIKELY(m_state.fetch_and(~(Writer | Sleepers), std::memory_order_release) & Sleepers)) {
+            wakeAll();
+        }
+        m_writersMutex.unlock();
+    }
+
+private:
+    ReadWriteLock(const ReadWriteLock &readWriteLock);
+    ReadWriteLock &operator=(const ReadWriteLock &readWriteLock);
+
+    enum State {
+        ReadersMask = (1 << 29) - 1, ///< How many readers hold the lock
+        Writer      = 1 << 29,       ///< A writer holds the lock, or waits for readers to leave
+        Sleepers    = 1 << 30        ///< Somebody may be sleeping on m_state
+    };
+
+    void lockForReadSlow();
+    void waitForReaders();
+    void wakeAll();
+
+    std::atomic<iint32> m_state;
+    Mutex               m_writersMutex; ///< Makes writers wait for each other
+};
+
+}
+
+#endif //READ_WRITE_LOCK_H
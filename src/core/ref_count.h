@@ -0,0 +1,83 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef REF_COUNT_H
+#define REF_COUNT_H
+
+#include <ideal_export.h>
+
+#include <atomic>
+
+namespace IdealCore {
+
+/**
+  * @class RefCount ref_count.h core/ref_count.h
+  *
+  * @internal
+  *
+  * The reference count of data implicitly shared by value types, such as String or Vector. It can
+  * be shared from several threads at the same time: taking a reference is a relaxed increment, and
+  * releasing it synchronizes with all other releases, so the thread that releases the last one
+  * sees every change made to the data before deleting it.
+  *
+  * @note The count can be safely read with isShared() to decide whether to detach, as long as the
+  *       calling thread holds a reference. If it is not shared, nobody else can take a new one.
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class RefCount
+{
+public:
+    RefCount(iint32 count = 1)
+        : m_count(count)
+    {
+    }
+
+    void ref()
+    {
+        m_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+      * @return Whether this was the last reference, so the shared data has to be deleted.
+      */
+    bool deref()
+    {
+        return m_count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    /**
+      * @return Whether other references exist besides the one of the calling thread.
+      */
+    bool isShared() const
+    {
+        return m_count.load(std::memory_order_acquire) > 1;
+    }
+
+private:
+    RefCount(const RefCount &refCount);
+    RefCount &operator=(const RefCount &refCount);
+
+    std::atomic<iint32> m_count;
+};
+
+}
+
+#endif //REF_COUNT_H
@@ -19,6 +19,7 @@
  */
 
 #include "reg_exp.h"
+#include "ref_count.h"
 
 #include <vector>
 #include <pcre.h>
@@ -38,14 +39,16 @@ public:
     void ref();
     void deref();
 
+    /**
+      * @return The data shared by all empty regular expressions, which is never deleted.
+      */
+    static Private *sharedEmpty();
     static Private *empty();
 
     String              m_regExp;
     pcre               *m_pcre;
     std::vector<String> m_captures;
-    size_t              m_refs;
-
-    static Private *m_privateEmpty;
+    RefCount            m_refs;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -63,11 +66,9 @@ RegExp::Private::~Private()
 
 void RegExp::Private::newAndDetach(RegExp *regExp)
 {
-    if (m_refs > 1) {
+    if (m_refs.isShared()) {
         regExp->d = new Private;
         deref();
-    } else if (this == m_privateEmpty) {
-        m_privateEmpty = 0;
     } else {
         clearContents();
     }
@@ -83,31 +84,28 @@ void RegExp::Private::clearContents()
 
 void RegExp::Private::ref()
 {
-    ++m_refs;
+    m_refs.ref();
 }
 
 void RegExp::Private::deref()
 {
-    --m_refs;
-    if (!m_refs) {
-        if (this == m_privateEmpty) {
-            m_privateEmpty = 0;
-        }
+    if (m_refs.deref()) {
         delete this;
     }
 }
 
-RegExp::Private *RegExp::Private::empty()
+RegExp::Private *RegExp::Private::sharedEmpty()
 {
-    if (!m_privateEmpty) {
-        m_privateEmpty = new Private;
-    } else {
-        m_privateEmpty->ref();
-    }
-    return m_privateEmpty;
+    static Private *const privateEmpty = new Private;
+    return privateEmpty;
 }
 
-RegExp::Private *RegExp::Private::m_privateEmpty = 0;
+RegExp::Private *RegExp::Private::empty()
+{
+    Private *const res = sharedEmpty();
+    res->ref();
+    return res;
+}
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
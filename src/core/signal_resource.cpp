@@ -34,11 +34,7 @@ void SignalResource::signalCreated(const SignalBase *signal)
 {
 }
 
-void SignalResource::signalConnected(const SignalBase *signal)
-{
-}
-
-void SignalResource::signalDisconnected(const SignalBase *signal)
+void SignalResource::signalConnected(const SignalBase *signal, const Connection &connection)
 {
 }
 
@@ -23,28 +23,17 @@
 
 #include <ideal_export.h>
 #include <core/list.h>
-#include <core/mutex.h>
 
 namespace IdealCore {
 
 class SignalBase;
+class Connection;
 
 /**
   * @internal
   */
 class IDEAL_EXPORT SignalResource
 {
-    friend class Object;
-    friend class SignalBase;
-    template <typename Receiver, typename Member, typename... Param>
-    friend class Callback;
-    template <typename Receiver, typename Member, typename... Param>
-    friend class CallbackSynchronized;
-    template <typename Receiver, typename Member, typename... Param>
-    friend class CallbackMulti;
-    template <typename Receiver, typename Member, typename... Param>
-    friend class CallbackMultiSynchronized;
-
 public:
     SignalResource();
     virtual ~SignalResource();
@@ -56,16 +45,10 @@ public:
     virtual void signalCreated(const SignalBase *signal);
 
     /**
-      * Notifies the signal resource that @p signal has been connected. This allows us to be aware
-      * of the signals connected to this signal resource.
+      * Notifies the signal resource that @p signal has been connected to it through @p connection.
+      * This allows us to be aware of the connections this signal resource is the receiver of.
       */
-    virtual void signalConnected(const SignalBase *signal);
-
-    /**
-      * Notifies the signal resource that @p signal has been disconnected. This allows us to be aware
-      * of the signals connected to this signal resource.
-      */
-    virtual void signalDisconnected(const SignalBase *signal);
+    virtual void signalConnected(const SignalBase *signal, const Connection &connection);
 
     /**
       * Returns the list of signals that exist on this object.
@@ -76,9 +59,6 @@ public:
       * Returns whether emit() is blocked for this object or not.
       */
     virtual bool isEmitBlocked() const;
-
-private:
-    Mutex m_mutex;
 };
 
 }
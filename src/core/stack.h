@@ -21,6 +21,8 @@
 #ifndef STACK_H
 #define STACK_H
 
+#include <core/ref_count.h>
+
 namespace IdealCore {
 
 /**
@@ -70,20 +72,20 @@ public:
     void ref();
     void deref();
 
+    /**
+      * @return The data shared by all empty stacks, which is never deleted.
+      */
+    static Private *sharedEmpty();
     static Private *empty();
 
-    T     *m_stack;
-    size_t m_top;
-    size_t m_capacity;
-    size_t m_refs;
+    T       *m_stack;
+    size_t   m_top;
+    size_t   m_capacity;
+    RefCount m_refs;
 
-    static Private *m_privateEmpty;
-    static T        m_emptyRes;
+    static T m_emptyRes;
 };
 
-template <typename T>
-typename Stack<T>::Private *Stack<T>::Private::m_privateEmpty = 0;
-
 template <typename T>
 T Stack<T>::Private::m_emptyRes = T();
 
@@ -120,22 +122,18 @@ typename Stack<T>::Private *Stack<T>::Private::copy() const
 template <typename T>
 void Stack<T>::Private::copyAndDetach(Stack<T> *stack)
 {
-    if (m_refs > 1) {
+    if (m_refs.isShared()) {
         stack->d = copy();
         deref();
-    } else if (this == m_privateEmpty) {
-        m_privateEmpty = 0;
     }
 }
 
 template <typename T>
 void Stack<T>::Private::newAndDetach(Stack<T> *stack)
 {
-    if (m_refs > 1) {
+    if (m_refs.isShared()) {
         stack->d = new Private;
         deref();
-    } else if (this == m_privateEmpty) {
-        m_privateEmpty = 0;
     } else {
         clearContents();
     }
@@ -153,30 +151,30 @@ void Stack<T>::Private::clearContents()
 template <typename T>
 void Stack<T>::Private::ref()
 {
-    ++m_refs;
+    m_refs.ref();
 }
 
 template <typename T>
 void Stack<T>::Private::deref()
 {
-    --m_refs;
-    if (!m_refs) {
-        if (this == m_privateEmpty) {
-            m_privateEmpty = 0;
-        }
+    if (m_refs.deref()) {
         delete this;
     }
 }
 
+template <typename T>
+typename Stack<T>::Private *Stack<T>::Private::sharedEmpty()
+{
+    static Private *const privateEmpty = new Private;
+    return privateEmpty;
+}
+
 template <typename T>
 typename Stack<T>::Private *Stack<T>::Private::empty()
 {
-    if (!m_privateEmpty) {
-        m_privateEmpty = new Private;
-    } else {
-        m_privateEmpty->ref();
-    }
-    return m_privateEmpty;
+    Private *const res = sharedEmpty();
+    res->ref();
+    return res;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -270,7 +268,7 @@ bool Stack<T>::empty() const
 template <typename T>
 void Stack<T>::clear()
 {
-    if (d == Private::m_privateEmpty) {
+    if (d == Private::sharedEmpty()) {
         return;
     }
     d->deref();
@@ -24,6 +24,12 @@
 #include <cppunit/extensions/TestFactoryRegistry.h>
 #include <cppunit/ui/text/TestRunner.h>
 #include <core/application.h>
+#include <core/timer.h>
+#include <core/event.h>
+#include <core/thread.h>
+#include <core/worker_thread.h>
+
+#include <atomic>
 
 #include <unistd.h>
 #include <stdlib.h>
@@ -186,6 +192,213 @@ void ApplicationTest::testFlexible()
     delete instance;
 }
 
+static Mutex timeoutCountMutex;
+static iint32 timeoutCount = 0;
+
+static void countTimeout()
+{
+    ContextMutexLocker cml(timeoutCountMutex);
+    ++timeoutCount;
+}
+
+void ApplicationTest::testDispatcherPool()
+{
+    optind = 1;
+    const ichar *argv[] = {"app"};
+    Application *instance = new Application(1, (ichar**) argv);
+    instance->setDispatcherPoolSize(2);
+    instance->setDispatcherQueueDepth(8);
+    CPPUNIT_ASSERT_EQUAL(2, instance->dispatcherPoolSize());
+    CPPUNIT_ASSERT_EQUAL(8, instance->dispatcherQueueDepth());
+    CPPUNIT_ASSERT(instance->dispatcherStats().empty());
+    Timer *timer = new Timer(instance);
+    timer->timeout.connectStatic(countTimeout);
+    for (iint32 i = 0; i < 100; ++i) {
+        instance->postEvent(new Event(timer, Event::Timeout));
+    }
+    iuint64 eventsDispatched = 0;
+    for (iint32 i = 0; i < 500 && eventsDispatched < 100; ++i) {
+        Timer::wait(10);
+        eventsDispatched = 0;
+        List<Application::DispatcherStats> stats = instance->dispatcherStats();
+        List<Application::DispatcherStats>::const_iterator it;
+        for (it = stats.begin(); it != stats.end(); ++it) {
+            eventsDispatched += (*it).eventsDispatched;
+        }
+        CPPUNIT_ASSERT_EQUAL((size_t) 2, stats.size());
+    }
+    CPPUNIT_ASSERT_EQUAL((iuint64) 100, eventsDispatched);
+    CPPUNIT_ASSERT_EQUAL(0, instance->pendingEvents());
+    {
+        ContextMutexLocker cml(timeoutCountMutex);
+        CPPUNIT_ASSERT_EQUAL(100, timeoutCount);
+    }
+    // Retired workers are joined by later resizes, while others keep dispatching
+    for (iint32 i = 0; i < 20; ++i) {
+        instance->setDispatcherPoolSize(1 + i % 3);
+        instance->postEvent(new Event(timer, Event::Timeout));
+    }
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, instance->dispatcherStats().size());
+    delete instance;
+}
+
+static std::atomic<iint32> destroyedCount(0);
+
+static void countDestroyed()
+{
+    destroyedCount.fetch_add(1);
+}
+
+class MarkingThread
+    : public Thread
+{
+public:
+    MarkingThread(Object *parent, Object **objects, iint32 count)
+        : Thread(parent, Joinable)
+        , m_objects(objects)
+        , m_count(count)
+    {
+    }
+
+protected:
+    virtual void run()
+    {
+        for (iint32 i = 0; i < m_count; ++i) {
+            m_objects[i]->deleteLater();
+            m_objects[i]->deleteLater();
+        }
+    }
+
+private:
+    Object **const m_objects;
+    const iint32   m_count;
+};
+
+void ApplicationTest::testDeleteLater()
+{
+    optind = 1;
+    const ichar *argv[] = {"app"};
+    Application *instance = new Application(1, (ichar**) argv);
+    WorkerThread *worker = new WorkerThread(instance);
+    const iint32 threadCount = 4;
+    const iint32 objectsPerThread = 25000;
+    const iint32 objectCount = threadCount * objectsPerThread;
+    Object **objects = new Object*[objectCount];
+    for (iint32 i = 0; i < objectCount; ++i) {
+        objects[i] = new Object(worker);
+        objects[i]->destroyed.connectStatic(countDestroyed);
+    }
+    // Objects marked for deletion and then deleted by hand must not be deleted again by the loop
+    objects[0]->deleteLater();
+    delete objects[0];
+    objects[objectCount - 1]->deleteLater();
+    delete objects[objectCount - 1];
+    CPPUNIT_ASSERT_EQUAL(2, destroyedCount.load());
+    const iint64 start = Timer::monotonicTime();
+    MarkingThread *threads[threadCount];
+    for (iint32 i = 0; i < threadCount; ++i) {
+        const iint32 first = i ? i * objectsPerThread : 1;
+        const iint32 count = (i == threadCount - 1) ? objectCount - 1 - first : (i + 1) * objectsPerThread - first;
+        threads[i] = new MarkingThread(instance, objects + first, count);
+        threads[i]->exec();
+    }
+    for (iint32 i = 0; i < threadCount; ++i) {
+        threads[i]->join();
+    }
+    IDEAL_SDEBUG("*** Marked " << (objectCount - 2) << " objects for deletion from " << threadCount << " threads in " << ((Timer::monotonicTime() - start) / 1000) << " usecs");
+    worker->exec();
+    worker->quit();
+    worker->join();
+    CPPUNIT_ASSERT_EQUAL(objectCount, destroyedCount.load());
+    CPPUNIT_ASSERT(worker->children().empty());
+    delete[] objects;
+    delete instance;
+}
+
+class ProfiledObject
+    : public Object
+{
+public:
+    ProfiledObject(Object *parent)
+        : Object(parent)
+        , IDEAL_SIGNAL_INIT(profiledSignal, iint32)
+    {
+    }
+
+    void profiledSlot(iint32)
+    {
+    }
+
+public:
+    IDEAL_SIGNAL(profiledSignal, iint32);
+};
+
+void ApplicationTest::testSignalStats()
+{
+    optind = 1;
+    const ichar *argv[] = {"app"};
+    Application *instance = new Application(1, (ichar**) argv);
+#ifdef IDEAL_SIGNAL_PROFILING
+    ProfiledObject *first = new ProfiledObject(instance);
+    ProfiledObject *second = new ProfiledObject(instance);
+    first->profiledSignal.connect(second, &ProfiledObject::profiledSlot);
+    second->profiledSignal.connect(first, &ProfiledObject::profiledSlot);
+    second->profiledSignal.connect(second, &ProfiledObject::profiledSlot);
+    for (iint32 i = 0; i < 10; ++i) {
+        first->profiledSignal.emit(i);
+        second->profiledSignal.emit(i);
+    }
+    bool found = false;
+    List<Application::SignalStats> stats = instance->signalStats();
+    List<Application::SignalStats>::const_iterator it;
+    for (it = stats.begin(); it != stats.end(); ++it) {
+        if ((*it).name == "profiledSignal") {
+            CPPUNIT_ASSERT((*it).signature == "iint32");
+            CPPUNIT_ASSERT_EQUAL((iuint64) 20, (*it).emissions);
+            CPPUNIT_ASSERT_EQUAL((iuint64) 30, (*it).slotCalls);
+            CPPUNIT_ASSERT_EQUAL((iuint64) 2, (*it).maxSlots);
+            found = true;
+        }
+    }
+    CPPUNIT_ASSERT(found);
+#else
+    CPPUNIT_ASSERT(instance->signalStats().empty());
+#endif
+    delete instance;
+}
+
+void ApplicationTest::testMutexStats()
+{
+    optind = 1;
+    const ichar *argv[] = {"app"};
+    Application *instance = new Application(1, (ichar**) argv);
+#ifdef IDEAL_MUTEX_PROFILING
+    Mutex mutex(Mutex::Recursive); const iint32 mutexLine = __LINE__;
+    for (iint32 i = 0; i < 10; ++i) {
+        mutex.lock();
+        mutex.lock();
+        mutex.unlock();
+        mutex.unlock();
+    }
+    CPPUNIT_ASSERT(mutex.tryLock());
+    mutex.unlock();
+    bool found = false;
+    List<Application::MutexStats> stats = instance->mutexStats();
+    List<Application::MutexStats>::const_iterator it;
+    for (it = stats.begin(); it != stats.end(); ++it) {
+        if ((*it).file == __FILE__ && (*it).line == mutexLine) {
+            CPPUNIT_ASSERT_EQUAL((iuint64) 11, (*it).acquisitions);
+            CPPUNIT_ASSERT_EQUAL((iuint64) 0, (*it).contentions);
+            found = true;
+        }
+    }
+    CPPUNIT_ASSERT(found);
+#else
+    CPPUNIT_ASSERT(instance->mutexStats().empty());
+#endif
+    delete instance;
+}
+
 int main(int argc, char **argv)
 {
     CppUnit::Test *suite = CppUnit::TestFactoryRegistry::getRegistry().makeTest();
@@ -35,6 +35,10 @@ class ApplicationTest
     CPPUNIT_TEST(testValidLongOption);
     CPPUNIT_TEST(testStrict);
     CPPUNIT_TEST(testFlexible);
+    CPPUNIT_TEST(testDispatcherPool);
+    CPPUNIT_TEST(testDeleteLater);
+    CPPUNIT_TEST(testSignalStats);
+    CPPUNIT_TEST(testMutexStats);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -49,6 +53,10 @@ public:
     void testValidLongOption();
     void testStrict();
     void testFlexible();
+    void testDispatcherPool();
+    void testDeleteLater();
+    void testSignalStats();
+    void testMutexStats();
 };
 
 #endif //APPLICATION_TEST_H
@@ -24,11 +24,24 @@
 #include <cppunit/extensions/TestFactoryRegistry.h>
 #include <cppunit/ui/text/TestRunner.h>
 #include <core/object.h>
+#include <core/thread.h>
 #include <core/application.h>
+#include <core/timer.h>
+#include <core/event.h>
+#include <core/private/event_dispatcher_p.h>
+
+#include <atomic>
+
+#include <pthread.h>
+#include <sys/wait.h>
+#include <sys/types.h>
+#include <unistd.h>
 
 using namespace IdealCore;
 
 static Application *s_app = 0;
+static iint32       s_argc;
+static ichar      **s_argv;
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ConnectionTest);
 
@@ -140,6 +153,17 @@ void ConnectionTest::connectTest()
         emitter->signal.disconnect(signalSpy, &SignalSpy::receiveSignal);
         CPPUNIT_ASSERT_EQUAL(0, signalSpy->signalsReceived());
     }
+    {
+        signalSpy->reset();
+        emitter->signal.connect(signalSpy, &SignalSpy::receiveSignal);
+        signalSpy->setBlockedSignals(true);
+        emitter->emitSignal();
+        CPPUNIT_ASSERT_EQUAL(0, signalSpy->signalsReceived());
+        signalSpy->setBlockedSignals(false);
+        emitter->emitSignal();
+        emitter->signal.disconnect(signalSpy, &SignalSpy::receiveSignal);
+        CPPUNIT_ASSERT_EQUAL(1, signalSpy->signalsReceived());
+    }
     Emitter *secondEmitter = new Emitter(s_app);
     {
         signalSpy->reset();
@@ -150,10 +174,515 @@ void ConnectionTest::connectTest()
     }
 }
 
+class QueuedReceiver
+    : public Object
+{
+public:
+    QueuedReceiver(Object *parent)
+        : Object(parent)
+        , m_thread(pthread_self())
+        , m_sum(0)
+        , m_wrongThread(false)
+    {
+    }
+
+    void receiveValue(iint32 value, const String &name)
+    {
+        m_sum += value;
+        m_wrongThread = m_wrongThread || !pthread_equal(m_thread, pthread_self()) || name != "value";
+    }
+
+    void finished()
+    {
+        CPPUNIT_ASSERT(!m_wrongThread);
+        CPPUNIT_ASSERT_EQUAL(5050, m_sum);
+        application()->quit();
+    }
+
+    const pthread_t m_thread;
+    iint32          m_sum;
+    bool            m_wrongThread;
+};
+
+class QueuedEmitter
+    : public Thread
+{
+public:
+    QueuedEmitter(Object *parent)
+        : Thread(parent)
+        , IDEAL_SIGNAL_INIT(value, iint32, String)
+        , IDEAL_SIGNAL_INIT(finished)
+    {
+    }
+
+    IDEAL_SIGNAL(value, iint32, String);
+    IDEAL_SIGNAL(finished);
+
+protected:
+    virtual void run()
+    {
+        for (iint32 i = 1; i <= 100; ++i) {
+            value.emit(i, "value");
+        }
+        finished.emit();
+    }
+};
+
+void ConnectionTest::queuedConnectTest()
+{
+    iint32 res;
+    const pid_t pid = fork();
+    if (!pid) {
+        Application app(s_argc, s_argv);
+        QueuedReceiver *receiver = new QueuedReceiver(&app);
+        QueuedEmitter *emitter = new QueuedEmitter(&app);
+        emitter->value.connectQueued(receiver, &QueuedReceiver::receiveValue);
+        emitter->finished.connectQueued(receiver, &QueuedReceiver::finished);
+        emitter->execAndJoin();
+        // Nothing is called until the receiver event loop runs
+        CPPUNIT_ASSERT_EQUAL(0, receiver->m_sum);
+        app.exec();
+    } else {
+        waitpid(pid, &res, 0);
+        CPPUNIT_ASSERT(WIFEXITED(res));
+        CPPUNIT_ASSERT_EQUAL(EXIT_SUCCESS, WEXITSTATUS(res));
+    }
+}
+
+class Disconnector
+    : public Object
+{
+public:
+    Disconnector(Object *parent, Emitter *emitter, SignalSpy *signalSpy)
+        : Object(parent)
+        , m_emitter(emitter)
+        , m_signalSpy(signalSpy)
+    {
+    }
+
+    void disconnectSpy()
+    {
+        m_emitter->signal.disconnect(m_signalSpy, &SignalSpy::receiveSignal);
+    }
+
+private:
+    Emitter   *m_emitter;
+    SignalSpy *m_signalSpy;
+};
+
+class EmitterThread
+    : public Thread
+{
+public:
+    EmitterThread(Object *parent, Emitter *emitter)
+        : Thread(parent, Joinable)
+        , m_emitter(emitter)
+    {
+    }
+
+protected:
+    virtual void run()
+    {
+        for (iint32 i = 0; i < 100000; ++i) {
+            m_emitter->emitSignal();
+        }
+    }
+
+private:
+    Emitter *m_emitter;
+};
+
+void ConnectionTest::disconnectOnEmitTest()
+{
+    Emitter *emitter = new Emitter(s_app);
+    {
+        // A slot disconnected by a previous slot of the same emission is not called
+        signalSpy->reset();
+        Disconnector *disconnector = new Disconnector(s_app, emitter, signalSpy);
+        emitter->signal.connect(disconnector, &Disconnector::disconnectSpy);
+        emitter->signal.connect(signalSpy, &SignalSpy::receiveSignal);
+        emitter->emitSignal();
+        CPPUNIT_ASSERT_EQUAL(0, signalSpy->signalsReceived());
+        emitter->emitSignal();
+        CPPUNIT_ASSERT_EQUAL(0, signalSpy->signalsReceived());
+        delete disconnector;
+    }
+    {
+        // Connecting and disconnecting while other thread is emitting
+        SignalSpy *threadSpy = new SignalSpy(s_app);
+        EmitterThread *emitterThread = new EmitterThread(s_app, emitter);
+        emitterThread->exec();
+        for (iint32 i = 0; i < 1000; ++i) {
+            emitter->signal.connect(threadSpy, &SignalSpy::receiveSignal);
+            emitter->signal.disconnect(threadSpy, &SignalSpy::receiveSignal);
+        }
+        emitterThread->join();
+        threadSpy->reset();
+        emitter->emitSignal();
+        CPPUNIT_ASSERT_EQUAL(0, threadSpy->signalsReceived());
+        delete emitterThread;
+        delete threadSpy;
+    }
+    delete emitter;
+}
+
+class EmitterDeleter
+    : public Object
+{
+public:
+    EmitterDeleter(Object *parent, Emitter *emitter)
+        : Object(parent)
+        , m_emitter(emitter)
+    {
+    }
+
+    void deleteEmitter()
+    {
+        delete m_emitter;
+    }
+
+private:
+    Emitter *m_emitter;
+};
+
+void ConnectionTest::deleteOnEmitTest()
+{
+    signalSpy->reset();
+    Emitter *emitter = new Emitter(s_app);
+    EmitterDeleter *emitterDeleter = new EmitterDeleter(s_app, emitter);
+    emitter->signal.connect(signalSpy, &SignalSpy::receiveSignal);
+    emitter->signal.connect(emitterDeleter, &EmitterDeleter::deleteEmitter);
+    emitter->signal.connect(signalSpy, &SignalSpy::receiveSignal);
+    emitter->emitSignal();
+    CPPUNIT_ASSERT_EQUAL(1, signalSpy->signalsReceived());
+    delete emitterDeleter;
+}
+
+static iint32 staticSlotCalls = 0;
+
+static void staticSlot()
+{
+    ++staticSlotCalls;
+}
+
+void ConnectionTest::connectionHandleTest()
+{
+    Emitter *emitter = new Emitter(s_app);
+    {
+        signalSpy->reset();
+        Connection connection = emitter->signal.connect(signalSpy, &SignalSpy::receiveSignal);
+        CPPUNIT_ASSERT(connection.isConnected());
+        emitter->emitSignal();
+        CPPUNIT_ASSERT_EQUAL(1, signalSpy->signalsReceived());
+        connection.disconnect();
+        CPPUNIT_ASSERT(!connection.isConnected());
+        emitter->emitSignal();
+        CPPUNIT_ASSERT_EQUAL(1, signalSpy->signalsReceived());
+        connection.disconnect();
+    }
+    {
+        staticSlotCalls = 0;
+        const Connection connection = emitter->signal.connectStatic(staticSlot);
+        Connection copy = connection;
+        emitter->emitSignal();
+        copy.disconnect();
+        CPPUNIT_ASSERT(!connection.isConnected());
+        emitter->emitSignal();
+        CPPUNIT_ASSERT_EQUAL(1, staticSlotCalls);
+    }
+    {
+        // Destroying the receiver disconnects it, and the handle outlives both ends
+        SignalSpy *receiver = new SignalSpy(s_app);
+        const Connection connection = emitter->signal.connect(receiver, &SignalSpy::receiveSignal);
+        delete receiver;
+        CPPUNIT_ASSERT(!connection.isConnected());
+        emitter->emitSignal();
+        delete emitter;
+        CPPUNIT_ASSERT(!connection.isConnected());
+    }
+}
+
+void ConnectionTest::connectEmitDisconnectBenchmark()
+{
+    const iint32 cycles = 200000;
+    Emitter *emitter = new Emitter(s_app);
+    signalSpy->reset();
+    const iint64 start = Timer::monotonicTime();
+    for (iint32 i = 0; i < cycles; ++i) {
+        Connection connection = emitter->signal.connect(signalSpy, &SignalSpy::receiveSignal);
+        emitter->emitSignal();
+        connection.disconnect();
+    }
+    const iint64 elapsed = Timer::monotonicTime() - start;
+    CPPUNIT_ASSERT_EQUAL(cycles, signalSpy->signalsReceived());
+    IDEAL_SDEBUG("*** " << ((iint64) cycles * 1000000000LL / elapsed) << " connect/emit/disconnect cycles per second");
+    delete emitter;
+}
+
+static std::atomic<iint32> concurrentEmissions(0);
+static std::atomic<bool> stopEmitting(false);
+
+static void countConcurrentEmission()
+{
+    concurrentEmissions.fetch_add(1);
+}
+
+class EmittingThread
+    : public Thread
+{
+public:
+    EmittingThread(Object *parent, Emitter *emitter)
+        : Thread(parent, Joinable)
+        , m_emitter(emitter)
+    {
+    }
+
+protected:
+    virtual void run()
+    {
+        while (!stopEmitting.load()) {
+            m_emitter->emitSignal();
+        }
+    }
+
+private:
+    Emitter *m_emitter;
+};
+
+void ConnectionTest::connectWhileEmittingTest()
+{
+    const iint32 threadCount = 4;
+    const iint32 cycles = 10000;
+    Emitter *emitter = new Emitter(s_app);
+    emitter->signal.connectStatic(countConcurrentEmission);
+    emitter->signal.connectStatic(countConcurrentEmission);
+    EmittingThread *threads[threadCount];
+    for (iint32 i = 0; i < threadCount; ++i) {
+        threads[i] = new EmittingThread(s_app, emitter);
+        threads[i]->exec();
+    }
+    while (concurrentEmissions.load() < 1000) {
+        Timer::wait(1);
+    }
+    // Connecting and disconnecting never waits for the emitting threads
+    const iint64 start = Timer::monotonicTime();
+    for (iint32 i = 0; i < cycles; ++i) {
+        Connection connection = emitter->signal.connect(signalSpy, &SignalSpy::receiveSignal);
+        connection.disconnect();
+    }
+    const iint64 elapsed = Timer::monotonicTime() - start;
+    stopEmitting = true;
+    for (iint32 i = 0; i < threadCount; ++i) {
+        threads[i]->join();
+        delete threads[i];
+    }
+    IDEAL_SDEBUG("*** " << ((iint64) cycles * 1000000000LL / elapsed) << " connect/disconnect cycles per second while " << threadCount << " threads emit");
+    delete emitter;
+}
+
+static std::atomic<iint32> parallelCalls(0);
+static std::atomic<iint32> parallelCallsFromHelpers(0);
+static pthread_t emitterThread;
+
+class ParallelReceiver
+    : public Object
+{
+public:
+    ParallelReceiver(Object *parent)
+        : Object(parent)
+    {
+    }
+
+    void receiveSignal()
+    {
+        Timer::wait(1);
+        if (!pthread_equal(pthread_self(), emitterThread)) {
+            parallelCallsFromHelpers.fetch_add(1);
+        }
+        parallelCalls.fetch_add(1);
+    }
+};
+
+void ConnectionTest::parallelEmitTest()
+{
+    const iint32 receivers = 200;
+    emitterThread = pthread_self();
+    Emitter *emitter = new Emitter(s_app);
+    emitter->signal.setEmissionPolicy(SignalBase::Parallel);
+    CPPUNIT_ASSERT_EQUAL(SignalBase::Parallel, emitter->signal.emissionPolicy());
+    for (iint32 i = 0; i < receivers; ++i) {
+        emitter->signal.connectThreadSafe(new ParallelReceiver(emitter), &ParallelReceiver::receiveSignal);
+    }
+    signalSpy->reset();
+    emitter->signal.connect(signalSpy, &SignalSpy::receiveSignal);
+    const iint64 start = Timer::monotonicTime();
+    emitter->emitSignal();
+    // emit() only returns when every slot has finished
+    CPPUNIT_ASSERT_EQUAL(receivers, parallelCalls.load());
+    CPPUNIT_ASSERT_EQUAL(1, signalSpy->signalsReceived());
+    CPPUNIT_ASSERT(parallelCallsFromHelpers.load() > 0);
+    IDEAL_SDEBUG("*** " << receivers << " slots of 1 msec each called in " << ((Timer::monotonicTime() - start) / 1000000) << " msecs, " << parallelCallsFromHelpers.load() << " of them from the dispatcher pool");
+    emitter->signal.disconnect(signalSpy, &SignalSpy::receiveSignal);
+    delete emitter;
+}
+
+void ConnectionTest::parallelDeleteOnEmitTest()
+{
+    const iint32 receivers = 200;
+    emitterThread = pthread_self();
+    parallelCalls = 0;
+    Emitter *emitter = new Emitter(s_app);
+    emitter->signal.setEmissionPolicy(SignalBase::Parallel);
+    ParallelReceiver *parallelReceivers[receivers];
+    for (iint32 i = 0; i < receivers; ++i) {
+        parallelReceivers[i] = new ParallelReceiver(s_app);
+        emitter->signal.connectThreadSafe(parallelReceivers[i], &ParallelReceiver::receiveSignal);
+    }
+    EmitterDeleter *emitterDeleter = new EmitterDeleter(s_app, emitter);
+    emitter->signal.connect(emitterDeleter, &EmitterDeleter::deleteEmitter);
+    emitter->emitSignal();
+    // Chunks claimed after the signal was destroyed are skipped
+    CPPUNIT_ASSERT(parallelCalls.load() < receivers);
+    delete emitterDeleter;
+    for (iint32 i = 0; i < receivers; ++i) {
+        delete parallelReceivers[i];
+    }
+}
+
+static std::atomic<bool> emittedFromDispatcher(false);
+
+class ParallelEmitter
+    : public EventDispatcher
+{
+public:
+    ParallelEmitter(Emitter *emitter)
+        : m_emitter(emitter)
+    {
+    }
+
+    virtual void dispatchEvent(Event *event)
+    {
+        // Wait for the queue to be full, so there is no room for helpers
+        while (s_app->pendingEvents() < s_app->dispatcherQueueDepth()) {
+            Timer::wait(1);
+        }
+        m_emitter->emitSignal();
+        emittedFromDispatcher = true;
+    }
+
+private:
+    Emitter *m_emitter;
+};
+
+class IdleDispatcher
+    : public EventDispatcher
+{
+public:
+    virtual void dispatchEvent(Event *event)
+    {
+    }
+};
+
+void ConnectionTest::parallelEmitFromDispatcherTest()
+{
+    const iint32 receivers = 32;
+    parallelCalls = 0;
+    // No helper can be posted, and the only worker is the one emitting
+    s_app->setDispatcherPoolSize(1);
+    s_app->setDispatcherQueueDepth(1);
+    Emitter *emitter = new Emitter(s_app);
+    emitter->signal.setEmissionPolicy(SignalBase::Parallel);
+    for (iint32 i = 0; i < receivers; ++i) {
+        emitter->signal.connectThreadSafe(new ParallelReceiver(emitter), &ParallelReceiver::receiveSignal);
+    }
+    ParallelEmitter parallelEmitter(emitter);
+    IdleDispatcher idleDispatcher;
+    s_app->postEvent(new Event(emitter, Event::Emission), &parallelEmitter);
+    s_app->postEvent(new Event(emitter, Event::Emission), &idleDispatcher);
+    for (iint32 i = 0; i < 500 && !emittedFromDispatcher.load(); ++i) {
+        Timer::wait(10);
+    }
+    CPPUNIT_ASSERT(emittedFromDispatcher.load());
+    CPPUNIT_ASSERT_EQUAL(receivers, parallelCalls.load());
+    s_app->setDispatcherPoolSize(4);
+    s_app->setDispatcherQueueDepth(1024);
+    while (s_app->pendingEvents()) {
+        Timer::wait(1);
+    }
+    delete emitter;
+}
+
+void ConnectionTest::functorConnectTest()
+{
+    Emitter *emitter = new Emitter(s_app);
+    iint32 calls = 0;
+    {
+        Connection connection = emitter->signal.connect([&calls]() {
+            ++calls;
+        });
+        emitter->emitSignal();
+        CPPUNIT_ASSERT_EQUAL(1, calls);
+        connection.disconnect();
+        emitter->emitSignal();
+        CPPUNIT_ASSERT_EQUAL(1, calls);
+    }
+    {
+        calls = 0;
+        SignalSpy *receiver = new SignalSpy(s_app);
+        emitter->signal.connect(receiver, [&calls, receiver]() {
+            receiver->receiveSignal();
+            ++calls;
+        });
+        emitter->emitSignal();
+        CPPUNIT_ASSERT_EQUAL(1, receiver->signalsReceived());
+        receiver->setBlockedSignals(true);
+        emitter->emitSignal();
+        CPPUNIT_ASSERT_EQUAL(1, receiver->signalsReceived());
+        // Destroying the receiver disconnects the functor
+        delete receiver;
+        emitter->emitSignal();
+        CPPUNIT_ASSERT_EQUAL(1, calls);
+    }
+    delete emitter;
+}
+
+void ConnectionTest::manyReceiversTest()
+{
+    const iint32 receiverCount = 20000;
+    Emitter *emitter = new Emitter(s_app);
+    Object *receiverParent = new Object(s_app);
+    SignalSpy **receivers = new SignalSpy*[receiverCount];
+    iint64 start = Timer::monotonicTime();
+    for (iint32 i = 0; i < receiverCount; ++i) {
+        receivers[i] = new SignalSpy(receiverParent);
+        emitter->signal.connect(receivers[i], &SignalSpy::receiveSignal);
+    }
+    const iint64 connectTime = Timer::monotonicTime() - start;
+    emitter->emitSignal();
+    for (iint32 i = 0; i < receiverCount; ++i) {
+        CPPUNIT_ASSERT_EQUAL(1, receivers[i]->signalsReceived());
+    }
+    start = Timer::monotonicTime();
+    for (iint32 i = 0; i < receiverCount; i += 2) {
+        delete receivers[i];
+    }
+    const iint64 deleteTime = Timer::monotonicTime() - start;
+    emitter->emitSignal();
+    for (iint32 i = 1; i < receiverCount; i += 2) {
+        CPPUNIT_ASSERT_EQUAL(2, receivers[i]->signalsReceived());
+    }
+    IDEAL_SDEBUG("*** Connected " << receiverCount << " receivers in " << connectTime / 1000 << " usec, deleted half of them in " << deleteTime / 1000 << " usec");
+    delete[] receivers;
+    delete receiverParent;
+    delete emitter;
+}
+
 int main(int argc, char **argv)
 {
     Application app(argc, argv);
     s_app = &app;
+    s_argc = argc;
+    s_argv = argv;
 
     CppUnit::Test *suite = CppUnit::TestFactoryRegistry::getRegistry().makeTest();
 
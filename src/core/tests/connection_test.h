@@ -30,6 +30,17 @@ class ConnectionTest
 {
     CPPUNIT_TEST_SUITE(ConnectionTest);
     CPPUNIT_TEST(connectTest);
+    CPPUNIT_TEST(queuedConnectTest);
+    CPPUNIT_TEST(disconnectOnEmitTest);
+    CPPUNIT_TEST(deleteOnEmitTest);
+    CPPUNIT_TEST(connectionHandleTest);
+    CPPUNIT_TEST(connectEmitDisconnectBenchmark);
+    CPPUNIT_TEST(connectWhileEmittingTest);
+    CPPUNIT_TEST(parallelEmitTest);
+    CPPUNIT_TEST(parallelDeleteOnEmitTest);
+    CPPUNIT_TEST(parallelEmitFromDispatcherTest);
+    CPPUNIT_TEST(functorConnectTest);
+    CPPUNIT_TEST(manyReceiversTest);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -37,6 +48,17 @@ public:
     void tearDown();
 
     void connectTest();
+    void queuedConnectTest();
+    void disconnectOnEmitTest();
+    void deleteOnEmitTest();
+    void connectionHandleTest();
+    void connectEmitDisconnectBenchmark();
+    void connectWhileEmittingTest();
+    void parallelEmitTest();
+    void parallelDeleteOnEmitTest();
+    void parallelEmitFromDispatcherTest();
+    void functorConnectTest();
+    void manyReceiversTest();
 
 private:
     SignalSpy *signalSpy;
@@ -0,0 +1,306 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "mutex_test.h"
+
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <core/application.h>
+#include <core/cond_var.h>
+#include <core/context_read_locker.h>
+#include <core/context_write_locker.h>
+#include <core/thread.h>
+#include <core/timer.h>
+
+using namespace IdealCore;
+
+static Application *s_app = 0;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MutexTest);
+
+void MutexTest::setUp()
+{
+}
+
+void MutexTest::tearDown()
+{
+}
+
+class TryLockThread
+    : public Thread
+{
+public:
+    TryLockThread(Object *parent, Mutex &mutex)
+        : Thread(parent, Joinable)
+        , m_mutex(mutex)
+        , m_locked(false)
+    {
+    }
+
+    Mutex &m_mutex;
+    bool   m_locked;
+
+protected:
+    virtual void run()
+    {
+        m_locked = m_mutex.tryLock();
+        if (m_locked) {
+            m_mutex.unlock();
+        }
+    }
+};
+
+void MutexTest::testLock()
+{
+    Mutex mutex;
+    CPPUNIT_ASSERT(mutex.tryLock());
+    CPPUNIT_ASSERT(!mutex.tryLock());
+    mutex.unlock();
+    mutex.lock();
+    TryLockThread *thread = new TryLockThread(s_app, mutex);
+    thread->execAndJoin();
+    CPPUNIT_ASSERT(!thread->m_locked);
+    mutex.unlock();
+    thread->execAndJoin();
+    CPPUNIT_ASSERT(thread->m_locked);
+    delete thread;
+}
+
+void MutexTest::testRecursive()
+{
+    Mutex mutex(Mutex::Recursive);
+    mutex.lock();
+    mutex.lock();
+    CPPUNIT_ASSERT(mutex.tryLock());
+    TryLockThread *thread = new TryLockThread(s_app, mutex);
+    mutex.unlock();
+    mutex.unlock();
+    thread->execAndJoin();
+    CPPUNIT_ASSERT(!thread->m_locked);
+    mutex.unlock();
+    thread->execAndJoin();
+    CPPUNIT_ASSERT(thread->m_locked);
+    delete thread;
+}
+
+class SignalingThread
+    : public Thread
+{
+public:
+    SignalingThread(Object *parent, Mutex &mutex, CondVar &condVar, bool &ready)
+        : Thread(parent, Joinable)
+        , m_mutex(mutex)
+        , m_condVar(condVar)
+        , m_ready(ready)
+    {
+    }
+
+protected:
+    virtual void run()
+    {
+        Timer::wait(50);
+        ContextMutexLocker cml(m_mutex);
+        m_ready = true;
+        m_condVar.signal();
+    }
+
+private:
+    Mutex   &m_mutex;
+    CondVar &m_condVar;
+    bool    &m_ready;
+};
+
+void MutexTest::testCondVar()
+{
+    Mutex mutex;
+    CondVar condVar(mutex);
+    bool ready = false;
+    {
+        ContextMutexLocker cml(mutex);
+        const iint64 start = Timer::monotonicTime();
+        condVar.timedWait(20);
+        CPPUNIT_ASSERT(Timer::monotonicTime() - start >= 15000000LL);
+    }
+    SignalingThread *thread = new SignalingThread(s_app, mutex, condVar, ready);
+    thread->exec();
+    {
+        ContextMutexLocker cml(mutex);
+        while (!ready) {
+            condVar.wait();
+        }
+    }
+    thread->join();
+    delete thread;
+}
+
+class ContendingThread
+    : public Thread
+{
+public:
+    ContendingThread(Object *parent, Mutex &mutex, iint64 &counter, iint32 iterations)
+        : Thread(parent, Joinable)
+        , m_mutex(mutex)
+        , m_counter(counter)
+        , m_iterations(iterations)
+    {
+    }
+
+protected:
+    virtual void run()
+    {
+        for (iint32 i = 0; i < m_iterations; ++i) {
+            m_mutex.lock();
+            ++m_counter;
+            m_mutex.unlock();
+        }
+    }
+
+private:
+    Mutex  &m_mutex;
+    iint64 &m_counter;
+    iint32  m_iterations;
+};
+
+void MutexTest::testContentionBenchmark()
+{
+    const iint32 totalIterations = 1600000;
+    const iint32 threadCounts[] = {1, 4, 16};
+    for (iint32 i = 0; i < 3; ++i) {
+        const iint32 threadCount = threadCounts[i];
+        Mutex mutex;
+        iint64 counter = 0;
+        ContendingThread *threads[16];
+        for (iint32 j = 0; j < threadCount; ++j) {
+            threads[j] = new ContendingThread(s_app, mutex, counter, totalIterations / threadCount);
+        }
+        const iint64 start = Timer::monotonicTime();
+        for (iint32 j = 0; j < threadCount; ++j) {
+            threads[j]->exec();
+        }
+        for (iint32 j = 0; j < threadCount; ++j) {
+            threads[j]->join();
+            delete threads[j];
+        }
+        const iint64 elapsed = Timer::monotonicTime() - start;
+        CPPUNIT_ASSERT_EQUAL((iint64) totalIterations, counter);
+        IDEAL_SDEBUG("*** " << threadCount << " threads: " << ((iint64) totalIterations * 1000000000LL / elapsed) << " lock/unlock pairs per second");
+    }
+}
+
+class ReadWriteThread
+    : public Thread
+{
+public:
+    ReadWriteThread(Object *parent, ReadWriteLock &readWriteLock, iint64 *values, bool writer, iint32 iterations)
+        : Thread(parent, Joinable)
+        , m_inconsistentReads(0)
+        , m_readWriteLock(readWriteLock)
+        , m_values(values)
+        , m_writer(writer)
+        , m_iterations(iterations)
+    {
+    }
+
+    iint32 m_inconsistentReads;
+
+protected:
+    virtual void run()
+    {
+        for (iint32 i = 0; i < m_iterations; ++i) {
+            if (m_writer) {
+                ContextWriteLocker cwl(m_readWriteLock);
+                ++m_values[0];
+                ++m_values[1];
+            } else {
+                ContextReadLocker crl(m_readWriteLock);
+                if (m_values[0] != m_values[1]) {
+                    ++m_inconsistentReads;
+                }
+            }
+        }
+    }
+
+private:
+    ReadWriteLock &m_readWriteLock;
+    iint64        *m_values;
+    bool           m_writer;
+    iint32         m_iterations;
+};
+
+void MutexTest::testReadWriteLock()
+{
+    const iint32 iterations = 200000;
+    ReadWriteLock readWriteLock;
+    iint64 values[2] = {0, 0};
+    ReadWriteThread *threads[6];
+    for (iint32 i = 0; i < 6; ++i) {
+        threads[i] = new ReadWriteThread(s_app, readWriteLock, values, i % 3 == 0, iterations);
+        threads[i]->exec();
+    }
+    for (iint32 i = 0; i < 6; ++i) {
+        threads[i]->join();
+        CPPUNIT_ASSERT_EQUAL(0, threads[i]->m_inconsistentReads);
+        delete threads[i];
+    }
+    CPPUNIT_ASSERT_EQUAL((iint64) iterations * 2, values[0]);
+    CPPUNIT_ASSERT_EQUAL((iint64) iterations * 2, values[1]);
+}
+
+void MutexTest::testReadersBenchmark()
+{
+    const iint32 totalIterations = 1600000;
+    const iint32 threadCounts[] = {1, 4, 16};
+    for (iint32 i = 0; i < 3; ++i) {
+        const iint32 threadCount = threadCounts[i];
+        ReadWriteLock readWriteLock;
+        iint64 values[2] = {0, 0};
+        ReadWriteThread *threads[16];
+        for (iint32 j = 0; j < threadCount; ++j) {
+            threads[j] = new ReadWriteThread(s_app, readWriteLock, values, false, totalIterations / threadCount);
+        }
+        const iint64 start = Timer::monotonicTime();
+        for (iint32 j = 0; j < threadCount; ++j) {
+            threads[j]->exec();
+        }
+        for (iint32 j = 0; j < threadCount; ++j) {
+            threads[j]->join();
+            delete threads[j];
+        }
+        const iint64 elapsed = Timer::monotonicTime() - start;
+        IDEAL_SDEBUG("*** " << threadCount << " threads: " << ((iint64) totalIterations * 1000000000LL / elapsed) << " read lock/unlock pairs per second");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Application app(argc, argv);
+    s_app = &app;
+
+    CppUnit::Test *suite = CppUnit::TestFactoryRegistry::getRegistry().makeTest();
+
+    CppUnit::TextUi::TestRunner runner;
+    runner.addTest(suite);
+
+    runner.setOutputter(new CppUnit::CompilerOutputter(&runner.result(), std::cerr));
+    bool wasSuccessful = runner.run();
+
+    return wasSuccessful ? 0 : 1;
+}
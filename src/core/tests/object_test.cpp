@@ -0,0 +1,295 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "object_test.h"
+
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <core/object.h>
+#include <core/object_pool.h>
+#include <core/application.h>
+#include <core/timer.h>
+
+#include <atomic>
+#include <new>
+
+#include <stdlib.h>
+
+using namespace IdealCore;
+
+static Application *s_app = 0;
+
+// Counts the allocations done while s_countAllocations is set. Not inlined, so the compiler
+// does not complain about memory from operator new being released with free()
+static std::atomic<bool>    s_countAllocations(false);
+static std::atomic<iuint64> s_allocations(0);
+static std::atomic<iuint64> s_allocatedBytes(0);
+
+__attribute__((noinline)) void *operator new(size_t size)
+{
+    if (s_countAllocations.load(std::memory_order_relaxed)) {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+        s_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    void *const res = malloc(size ? size : 1);
+    if (!res) {
+        throw std::bad_alloc();
+    }
+    return res;
+}
+
+__attribute__((noinline)) void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ObjectTest);
+
+void ObjectTest::setUp()
+{
+}
+
+void ObjectTest::tearDown()
+{
+}
+
+static iint32 destroyedCount = 0;
+
+static void countDestroyed()
+{
+    ++destroyedCount;
+}
+
+void ObjectTest::testParenting()
+{
+    Object *root = new Object(s_app);
+    Object *child = new Object(root);
+    Object *grandChild = new Object(child);
+    Object *otherChild = new Object(root);
+    CPPUNIT_ASSERT(child->parent() == root);
+    CPPUNIT_ASSERT(grandChild->parent() == child);
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, root->children().size());
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, child->children().size());
+    grandChild->reparent(otherChild);
+    CPPUNIT_ASSERT(grandChild->parent() == otherChild);
+    CPPUNIT_ASSERT(child->children().empty());
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, otherChild->children().size());
+    Object *first = new Object(otherChild);
+    Object *last = new Object(otherChild);
+    grandChild->reparent(child);
+    grandChild->reparent(otherChild);
+    List<Object*> children = otherChild->children();
+    CPPUNIT_ASSERT_EQUAL((size_t) 3, children.size());
+    CPPUNIT_ASSERT(children.front() == first);
+    CPPUNIT_ASSERT(children.back() == grandChild);
+    delete first;
+    delete last;
+    CPPUNIT_ASSERT(otherChild->children().front() == grandChild);
+    child->destroyed.connectStatic(countDestroyed);
+    grandChild->destroyed.connectStatic(countDestroyed);
+    otherChild->destroyed.connectStatic(countDestroyed);
+    otherChild->setDeleteChildrenRecursively(false);
+    CPPUNIT_ASSERT(!otherChild->isDeleteChildrenRecursively());
+    otherChild->setDeleteChildrenRecursively(true);
+    delete root;
+    CPPUNIT_ASSERT_EQUAL(3, destroyedCount);
+}
+
+void ObjectTest::testConstructionBenchmark()
+{
+    enum {
+        ObjectCount = 100000
+    };
+    Object *root = new Object(s_app);
+    {
+        s_allocations.store(0);
+        s_allocatedBytes.store(0);
+        s_countAllocations.store(true);
+        Object *object = new Object(root);
+        s_countAllocations.store(false);
+        IDEAL_SDEBUG("*** An empty object takes " << s_allocatedBytes.load() << " bytes in " << s_allocations.load() << " allocations");
+        delete object;
+    }
+    Object **objects = new Object*[ObjectCount];
+    iint64 start = Timer::monotonicTime();
+    for (iint32 i = 0; i < ObjectCount; ++i) {
+        objects[i] = new Object(root);
+    }
+    const iint64 constructionTime = Timer::monotonicTime() - start;
+    start = Timer::monotonicTime();
+    for (iint32 i = ObjectCount - 1; i >= 0; --i) {
+        delete objects[i];
+    }
+    const iint64 destructionTime = Timer::monotonicTime() - start;
+    IDEAL_SDEBUG("*** Constructed " << ObjectCount << " objects in " << constructionTime / 1000 << " usec, destroyed them in " << destructionTime / 1000 << " usec");
+    CPPUNIT_ASSERT(root->children().empty());
+    for (iint32 i = 0; i < ObjectCount; ++i) {
+        objects[i] = new Object(i % 2 ? objects[i / 2] : root);
+    }
+    start = Timer::monotonicTime();
+    delete root;
+    IDEAL_SDEBUG("*** Deleted a tree of " << ObjectCount << " objects in " << (Timer::monotonicTime() - start) / 1000 << " usec");
+    delete[] objects;
+}
+
+class PooledObject
+    : public Object
+{
+public:
+    PooledObject(Object *parent)
+        : Object(parent)
+    {
+        m_payload[0] = 0;
+    }
+
+    iint32 m_payload[32];
+};
+
+void ObjectTest::testObjectPool()
+{
+    ObjectPool *pool = new ObjectPool(s_app);
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, pool->allocatedBlocks());
+    Object *first = new (pool) Object(pool);
+    Object *second = new (pool) PooledObject(first);
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, pool->allocatedBlocks());
+    // Not allocated from the pool, but its private data is
+    Object *third = new PooledObject(second);
+    CPPUNIT_ASSERT_EQUAL((size_t) 5, pool->allocatedBlocks());
+    CPPUNIT_ASSERT_EQUAL((size_t) 65536, pool->reservedMemory());
+    delete third;
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, pool->allocatedBlocks());
+    // Freed blocks are reused
+    for (iint32 i = 0; i < 1000; ++i) {
+        delete new (pool) PooledObject(first);
+    }
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, pool->allocatedBlocks());
+    CPPUNIT_ASSERT_EQUAL((size_t) 65536, pool->reservedMemory());
+    destroyedCount = 0;
+    first->destroyed.connectStatic(countDestroyed);
+    second->destroyed.connectStatic(countDestroyed);
+    // An object reparented out of the pool keeps its memory alive after the pool is deleted, and
+    // neither it nor its descendants allocate from the pool anymore
+    Object *survivor = new (pool) Object(pool);
+    Object *survivorChild = new Object(survivor);
+    CPPUNIT_ASSERT_EQUAL((size_t) 7, pool->allocatedBlocks());
+    survivor->reparent(s_app);
+    new Object(survivorChild);
+    CPPUNIT_ASSERT_EQUAL((size_t) 7, pool->allocatedBlocks());
+    delete pool;
+    CPPUNIT_ASSERT_EQUAL(2, destroyedCount);
+    CPPUNIT_ASSERT(survivor->parent() == s_app);
+    new Object(survivor);
+    new Object(survivorChild);
+    // Reparenting into a pool makes the subtree allocate from it
+    ObjectPool *otherPool = new ObjectPool(s_app);
+    survivor->reparent(otherPool);
+    new Object(survivorChild);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, otherPool->allocatedBlocks());
+    survivor->reparent(s_app);
+    delete otherPool;
+    delete survivor;
+    // Children that outlive their pool do not allocate from it either
+    pool = new ObjectPool(s_app);
+    pool->setDeleteChildrenRecursively(false);
+    Object *orphan = new Object(pool);
+    delete pool;
+    CPPUNIT_ASSERT(!orphan->parent());
+    new Object(orphan);
+    delete orphan;
+}
+
+void ObjectTest::testObjectPoolBenchmark()
+{
+    enum {
+        Rounds = 100,
+        ObjectCount = 1000
+    };
+    Object *objects[ObjectCount];
+    Object *root = new Object(s_app);
+    iint64 start = Timer::monotonicTime();
+    for (iint32 round = 0; round < Rounds; ++round) {
+        for (iint32 i = 0; i < ObjectCount; ++i) {
+            objects[i] = new PooledObject(root);
+        }
+        for (iint32 i = 0; i < ObjectCount; ++i) {
+            delete objects[i];
+        }
+    }
+    const iint64 heapTime = Timer::monotonicTime() - start;
+    delete root;
+    ObjectPool *pool = new ObjectPool(s_app);
+    start = Timer::monotonicTime();
+    for (iint32 round = 0; round < Rounds; ++round) {
+        for (iint32 i = 0; i < ObjectCount; ++i) {
+            objects[i] = new (pool) PooledObject(pool);
+        }
+        for (iint32 i = 0; i < ObjectCount; ++i) {
+            delete objects[i];
+        }
+    }
+    const iint64 poolTime = Timer::monotonicTime() - start;
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, pool->allocatedBlocks());
+    delete pool;
+    IDEAL_SDEBUG("*** Created and deleted " << Rounds * ObjectCount << " objects in " << heapTime / 1000 << " usec from the heap, " << poolTime / 1000 << " usec from a pool");
+}
+
+void ObjectTest::testGeniousPointer()
+{
+    enum {
+        Copies = 1000000
+    };
+    Object *object = new Object(s_app);
+    GeniousPointer<Object> pointer(object);
+    GeniousPointer<Object> copy(pointer);
+    GeniousPointer<Object> assigned(0);
+    CPPUNIT_ASSERT(assigned.isContentDestroyed());
+    assigned = copy;
+    CPPUNIT_ASSERT(pointer.content() == object);
+    CPPUNIT_ASSERT(assigned.content() == object);
+    iint64 start = Timer::monotonicTime();
+    for (iint32 i = 0; i < Copies; ++i) {
+        GeniousPointer<Object> temporary(pointer);
+        CPPUNIT_ASSERT(!temporary.isContentDestroyed());
+    }
+    IDEAL_SDEBUG("*** " << Copies << " genious pointer copies in " << (Timer::monotonicTime() - start) / 1000 << " usec");
+    delete object;
+    CPPUNIT_ASSERT(pointer.isContentDestroyed());
+    CPPUNIT_ASSERT(!copy.content());
+    CPPUNIT_ASSERT(!assigned.content());
+    GeniousPointer<Object> copyOfDestroyed(copy);
+    CPPUNIT_ASSERT(copyOfDestroyed.isContentDestroyed());
+}
+
+int main(int argc, char **argv)
+{
+    Application app(argc, argv);
+    s_app = &app;
+
+    CppUnit::Test *suite = CppUnit::TestFactoryRegistry::getRegistry().makeTest();
+
+    CppUnit::TextUi::TestRunner runner;
+    runner.addTest(suite);
+
+    runner.setOutputter(new CppUnit::CompilerOutputter(&runner.result(), std::cerr));
+    bool wasSuccessful = runner.run();
+
+    return wasSuccessful ? 0 : 1;
+}
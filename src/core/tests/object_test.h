@@ -0,0 +1,48 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef OBJECT_TEST_H
+#define OBJECT_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class ObjectTest
+    : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(ObjectTest);
+    CPPUNIT_TEST(testParenting);
+    CPPUNIT_TEST(testConstructionBenchmark);
+    CPPUNIT_TEST(testObjectPool);
+    CPPUNIT_TEST(testObjectPoolBenchmark);
+    CPPUNIT_TEST(testGeniousPointer);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testParenting();
+    void testConstructionBenchmark();
+    void testObjectPool();
+    void testObjectPoolBenchmark();
+    void testGeniousPointer();
+};
+
+#endif //OBJECT_TEST_H
@@ -26,9 +26,12 @@
 #include <cppunit/extensions/TestFactoryRegistry.h>
 #include <cppunit/ui/text/TestRunner.h>
 #include <core/application.h>
+#include <core/thread.h>
 
 using namespace IdealCore;
 
+static Application *s_app = 0;
+
 CPPUNIT_TEST_SUITE_REGISTRATION(StringTest);
 
 void StringTest::setUp()
@@ -450,6 +453,50 @@ void StringTest::testMisc()
     }
 }
 
+class CopyingThread
+    : public Thread
+{
+public:
+    CopyingThread(Object *parent, const String &str)
+        : Thread(parent, Joinable)
+        , m_str(str)
+        , m_mismatches(0)
+    {
+    }
+
+    const String &m_str;
+    iint32        m_mismatches;
+
+protected:
+    virtual void run()
+    {
+        for (iint32 i = 0; i < 100000; ++i) {
+            String copy(m_str);
+            String otherCopy;
+            otherCopy = copy;
+            if (otherCopy.size() != 11) {
+                ++m_mismatches;
+            }
+        }
+    }
+};
+
+void StringTest::testSharingBetweenThreads()
+{
+    const String str("Shared data");
+    CopyingThread *threads[4];
+    for (iint32 i = 0; i < 4; ++i) {
+        threads[i] = new CopyingThread(s_app, str);
+        threads[i]->exec();
+    }
+    for (iint32 i = 0; i < 4; ++i) {
+        threads[i]->join();
+        CPPUNIT_ASSERT_EQUAL(0, threads[i]->m_mismatches);
+        delete threads[i];
+    }
+    CPPUNIT_ASSERT_EQUAL(String("Shared data"), str);
+}
+
 String StringTest::returnSpecialChars()
 {
     return "áéíóúñ€%32";
@@ -458,6 +505,7 @@ String StringTest::returnSpecialChars()
 int main(int argc, char **argv)
 {
     Application app(argc, argv);
+    s_app = &app;
     CppUnit::Test *suite = CppUnit::TestFactoryRegistry::getRegistry().makeTest();
 
     CppUnit::TextUi::TestRunner runner;
@@ -39,6 +39,7 @@ class StringTest
     CPPUNIT_TEST(testToConversion);
     CPPUNIT_TEST(testNumber);
     CPPUNIT_TEST(testMisc);
+    CPPUNIT_TEST(testSharingBetweenThreads);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -56,6 +57,7 @@ public:
     void testToConversion();
     void testNumber();
     void testMisc();
+    void testSharingBetweenThreads();
 
 private:
     IdealCore::String returnSpecialChars();
@@ -0,0 +1,211 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "thread_test.h"
+
+#include <atomic>
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <core/application.h>
+#include <core/thread.h>
+#include <core/timer.h>
+
+using namespace IdealCore;
+
+static Application *s_app = 0;
+static std::atomic<iint32> s_started(0);
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ThreadTest);
+
+void ThreadTest::setUp()
+{
+    s_started = 0;
+}
+
+void ThreadTest::tearDown()
+{
+}
+
+static void countStarted()
+{
+    ++s_started;
+}
+
+class SlowThread
+    : public Thread
+{
+public:
+    SlowThread(Object *parent)
+        : Thread(parent, Joinable)
+        , m_finished(false)
+    {
+    }
+
+    bool m_finished;
+
+protected:
+    virtual void run()
+    {
+        Thread::run();
+        Timer::wait(50);
+        m_finished = true;
+    }
+};
+
+void ThreadTest::testExecAndJoin()
+{
+    SlowThread *thread = new SlowThread(s_app);
+    thread->started.connectStatic(countStarted);
+    CPPUNIT_ASSERT(!thread->isPooled());
+    thread->execAndJoin();
+    CPPUNIT_ASSERT(thread->m_finished);
+    CPPUNIT_ASSERT_EQUAL(1, s_started.load());
+    delete thread;
+}
+
+void ThreadTest::testPooled()
+{
+    SlowThread *thread = new SlowThread(s_app);
+    thread->started.connectStatic(countStarted);
+    thread->setPooled(true);
+    CPPUNIT_ASSERT(thread->isPooled());
+    thread->execAndJoin();
+    CPPUNIT_ASSERT(thread->m_finished);
+    CPPUNIT_ASSERT_EQUAL(1, s_started.load());
+    // Joinable threads can be reused, and join() must wait until run() returns
+    thread->m_finished = false;
+    thread->execAndJoin();
+    CPPUNIT_ASSERT(thread->m_finished);
+    CPPUNIT_ASSERT_EQUAL(2, s_started.load());
+    // Pooled threads that block do not keep others from being run
+    SlowThread *threads[8];
+    for (iint32 i = 0; i < 8; ++i) {
+        threads[i] = new SlowThread(s_app);
+        threads[i]->setPooled(true);
+        threads[i]->started.connectStatic(countStarted);
+        threads[i]->exec();
+    }
+    const iint64 start = Timer::monotonicTime();
+    for (iint32 i = 0; i < 8; ++i) {
+        threads[i]->join();
+        CPPUNIT_ASSERT(threads[i]->m_finished);
+        delete threads[i];
+    }
+    CPPUNIT_ASSERT(Timer::monotonicTime() - start < 8 * 50 * 1000000LL);
+    CPPUNIT_ASSERT_EQUAL(10, s_started.load());
+    delete thread;
+}
+
+void ThreadTest::testPooledNoJoinable()
+{
+    const iint32 threadCount = 100;
+    for (iint32 i = 0; i < threadCount; ++i) {
+        Thread *thread = new Thread(s_app, Thread::NoJoinable);
+        thread->setPooled(true);
+        thread->started.connectStatic(countStarted);
+        thread->exec();
+    }
+    const iint64 deadline = Timer::monotonicTime() + 5000000000LL;
+    while (s_started.load() < threadCount && Timer::monotonicTime() < deadline) {
+        Timer::wait(10);
+    }
+    CPPUNIT_ASSERT_EQUAL(threadCount, s_started.load());
+}
+
+class WaitForAllThread
+    : public Thread
+{
+public:
+    WaitForAllThread(Object *parent, iint32 threadCount)
+        : Thread(parent, Joinable)
+        , m_threadCount(threadCount)
+        , m_allStarted(false)
+    {
+    }
+
+    iint32 m_threadCount;
+    bool   m_allStarted;
+
+protected:
+    virtual void run()
+    {
+        Thread::run();
+        const iint64 deadline = Timer::monotonicTime() + 5000000000LL;
+        while (s_started.load() < m_threadCount && Timer::monotonicTime() < deadline) {
+            Timer::wait(1);
+        }
+        m_allStarted = s_started.load() == m_threadCount;
+    }
+};
+
+void ThreadTest::testPooledBeyondLimit()
+{
+    // More threads than the pool keeps, all of them running at the same time
+    const iint32 threadCount = 100;
+    WaitForAllThread *threads[threadCount];
+    for (iint32 i = 0; i < threadCount; ++i) {
+        threads[i] = new WaitForAllThread(s_app, threadCount);
+        threads[i]->setPooled(true);
+        threads[i]->started.connectStatic(countStarted);
+        threads[i]->exec();
+    }
+    for (iint32 i = 0; i < threadCount; ++i) {
+        threads[i]->join();
+        CPPUNIT_ASSERT(threads[i]->m_allStarted);
+        delete threads[i];
+    }
+}
+
+void ThreadTest::testPooledBenchmark()
+{
+    const iint32 iterations = 2000;
+    iint64 elapsed[2];
+    for (iint32 i = 0; i < 2; ++i) {
+        Thread *thread = new Thread(s_app, Thread::Joinable);
+        thread->started.connectStatic(countStarted);
+        thread->setPooled(i);
+        const iint64 start = Timer::monotonicTime();
+        for (iint32 j = 0; j < iterations; ++j) {
+            thread->execAndJoin();
+        }
+        elapsed[i] = Timer::monotonicTime() - start;
+        delete thread;
+    }
+    CPPUNIT_ASSERT_EQUAL(2 * iterations, s_started.load());
+    IDEAL_SDEBUG("*** unpooled: " << (elapsed[0] / iterations / 1000) << " usec per exec and join");
+    IDEAL_SDEBUG("*** pooled: " << (elapsed[1] / iterations / 1000) << " usec per exec and join");
+}
+
+int main(int argc, char **argv)
+{
+    Application app(argc, argv);
+    s_app = &app;
+
+    CppUnit::Test *suite = CppUnit::TestFactoryRegistry::getRegistry().makeTest();
+
+    CppUnit::TextUi::TestRunner runner;
+    runner.addTest(suite);
+
+    runner.setOutputter(new CppUnit::CompilerOutputter(&runner.result(), std::cerr));
+    bool wasSuccessful = runner.run();
+
+    return wasSuccessful ? 0 : 1;
+}
@@ -25,8 +25,10 @@
 #include <cppunit/ui/text/TestRunner.h>
 #include <core/timer.h>
 #include <core/application.h>
+#include <core/worker_thread.h>
 
 #include <stdlib.h>
+#include <pthread.h>
 #include <sys/wait.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -170,11 +172,195 @@ void TimerTest::testStop()
     }
 }
 
+static Application *staticApp = 0;
+static iint32 manyTimersTimeouts = 0;
+
+static void manyTimersTimeout()
+{
+    __sync_fetch_and_add(&manyTimersTimeouts, 1);
+}
+
+static void manyTimersFinished()
+{
+    CPPUNIT_ASSERT_EQUAL(50000, manyTimersTimeouts);
+    staticApp->quit();
+}
+
+void TimerTest::testManyTimers()
+{
+    const pid_t pid = fork();
+    if (!pid) {
+        const iint32 numTimers = 100000;
+        Application app(s_argc, s_argv);
+        staticApp = &app;
+        Timer **timers = new Timer*[numTimers];
+        for (iint32 i = 0; i < numTimers; ++i) {
+            timers[i] = new Timer(&app);
+            timers[i]->timeout.connectStatic(manyTimersTimeout);
+            timers[i]->setInterval(100 + (i * 7919) % 900);
+        }
+        iint64 start = Timer::monotonicTime();
+        for (iint32 i = 0; i < numTimers; ++i) {
+            timers[i]->start();
+        }
+        IDEAL_SDEBUG("*** Started " << numTimers << " timers in " << (Timer::monotonicTime() - start) / 1000 << " usec");
+        start = Timer::monotonicTime();
+        for (iint32 i = 0; i < numTimers; i += 2) {
+            timers[i]->stop();
+        }
+        IDEAL_SDEBUG("*** Stopped " << numTimers / 2 << " timers in " << (Timer::monotonicTime() - start) / 1000 << " usec");
+        Timer timer(&app);
+        timer.timeout.connectStatic(manyTimersFinished);
+        timer.setInterval(2000);
+        timer.start();
+        app.exec();
+    } else {
+        waitpid(pid, &res, 0);
+        CPPUNIT_ASSERT(WIFEXITED(res));
+        CPPUNIT_ASSERT_EQUAL(EXIT_SUCCESS, WEXITSTATUS(res));
+    }
+}
+
+static Timer *nsecTimer = 0;
+static iint64 nsecTimerStart = 0;
+
+static void nsecTimerFinished()
+{
+    // Every period is either a timeout or a missed timeout, no matter how late the main loop was.
+    // This runs on a worker, so more periods may have elapsed since timer2 timed out
+    const Timer::LatenessStats stats = nsecTimer->latenessStats();
+    const iint64 elapsedPeriods = (Timer::monotonicTime() - nsecTimerStart) / 250000;
+    CPPUNIT_ASSERT(stats.timeouts + stats.missedTimeouts >= 399);
+    CPPUNIT_ASSERT((iint64) (stats.timeouts + stats.missedTimeouts) <= elapsedPeriods + 1);
+    CPPUNIT_ASSERT(stats.maxLateness >= stats.lastLateness);
+    IDEAL_SDEBUG("*** " << stats.timeouts << " timeouts, " << stats.missedTimeouts << " missed, average lateness " << stats.totalLateness / stats.timeouts << " nsec");
+    nsecTimer->resetLatenessStats();
+    CPPUNIT_ASSERT_EQUAL((iuint64) 0, nsecTimer->latenessStats().timeouts);
+    staticApp->quit();
+}
+
+void TimerTest::testNsecInterval()
+{
+    const pid_t pid = fork();
+    if (!pid) {
+        Application app(s_argc, s_argv);
+        staticApp = &app;
+        Timer timer1(&app);
+        nsecTimer = &timer1;
+        timer1.setIntervalNsec(250000);
+        CPPUNIT_ASSERT_EQUAL((iint64) 250000, timer1.intervalNsec());
+        CPPUNIT_ASSERT_EQUAL(0, timer1.interval());
+        Timer timer2(&app);
+        timer2.timeout.connectStatic(nsecTimerFinished);
+        timer2.setInterval(100);
+        nsecTimerStart = Timer::monotonicTime();
+        timer1.start(Timer::NoSingleShot);
+        timer2.start();
+        app.exec();
+    } else {
+        waitpid(pid, &res, 0);
+        CPPUNIT_ASSERT(WIFEXITED(res));
+        CPPUNIT_ASSERT_EQUAL(EXIT_SUCCESS, WEXITSTATUS(res));
+    }
+}
+
+static pthread_t mainThread;
+static iint32 workerTimeouts = 0;
+static bool workerTimeoutInMainThread = false;
+
+static void workerTimeout()
+{
+    workerTimeoutInMainThread = workerTimeoutInMainThread || pthread_equal(mainThread, pthread_self());
+    if (++workerTimeouts == 5) {
+        CPPUNIT_ASSERT(!workerTimeoutInMainThread);
+        staticApp->quit();
+    }
+}
+
+static void workerTimedOut()
+{
+    exit(EXIT_FAILURE);
+}
+
+void TimerTest::testWorkerThread()
+{
+    const pid_t pid = fork();
+    if (!pid) {
+        Application app(s_argc, s_argv);
+        staticApp = &app;
+        mainThread = pthread_self();
+        WorkerThread *worker = new WorkerThread(&app);
+        Timer *timer = new Timer(worker);
+        timer->timeout.connectStatic(workerTimeout);
+        timer->setInterval(10);
+        timer->start(Timer::NoSingleShot);
+        worker->exec();
+        Timer timeout(&app);
+        timeout.timeout.connectStatic(workerTimedOut);
+        timeout.setInterval(2000);
+        timeout.start();
+        app.exec();
+    } else {
+        waitpid(pid, &res, 0);
+        CPPUNIT_ASSERT(WIFEXITED(res));
+        CPPUNIT_ASSERT_EQUAL(EXIT_SUCCESS, WEXITSTATUS(res));
+    }
+}
+
+class CallAfterReceiver
+    : public Object
+{
+public:
+    CallAfterReceiver(Object *parent)
+        : Object(parent)
+        , m_calls(0)
+    {
+    }
+
+    void call()
+    {
+        ++m_calls;
+    }
+
+    void check()
+    {
+        // The timer used by the first callAfter() deleted itself once it called the slot; only the
+        // one calling us is left
+        CPPUNIT_ASSERT_EQUAL(1, m_calls);
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, children().size());
+        staticApp->quit();
+    }
+
+private:
+    iint32 m_calls;
+};
+
+void TimerTest::testCallAfter()
+{
+    const pid_t pid = fork();
+    if (!pid) {
+        Application app(s_argc, s_argv);
+        staticApp = &app;
+        CallAfterReceiver *receiver = new CallAfterReceiver(&app);
+        Timer::callAfter(10, receiver, &CallAfterReceiver::call);
+        Timer::callAfter(100, receiver, &CallAfterReceiver::check);
+        Timer timeout(&app);
+        timeout.timeout.connectStatic(workerTimedOut);
+        timeout.setInterval(2000);
+        timeout.start();
+        app.exec();
+    } else {
+        waitpid(pid, &res, 0);
+        CPPUNIT_ASSERT(WIFEXITED(res));
+        CPPUNIT_ASSERT_EQUAL(EXIT_SUCCESS, WEXITSTATUS(res));
+    }
+}
+
 int main(int argc, char **argv)
 {
     s_argc = argc;
     s_argv = argv;
-    IDEAL_SDEBUG("*** This test will take 21 seconds at least. Please, be patient");
+    IDEAL_SDEBUG("*** This test will take 23 seconds at least. Please, be patient");
 
     CppUnit::Test *suite = CppUnit::TestFactoryRegistry::getRegistry().makeTest();
 
@@ -31,6 +31,10 @@ class TimerTest
     CPPUNIT_TEST(secondInterval);
     CPPUNIT_TEST(testLoops);
     CPPUNIT_TEST(testStop);
+    CPPUNIT_TEST(testManyTimers);
+    CPPUNIT_TEST(testNsecInterval);
+    CPPUNIT_TEST(testWorkerThread);
+    CPPUNIT_TEST(testCallAfter);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -41,6 +45,10 @@ public:
     void secondInterval();
     void testLoops();
     void testStop();
+    void testManyTimers();
+    void testNsecInterval();
+    void testWorkerThread();
+    void testCallAfter();
 };
 
 #endif //TIMER_TEST_H
@@ -25,6 +25,7 @@ namespace IdealCore {
 
 Thread::Private::Private(Type type)
     : m_type(type)
+    , m_pooled(false)
 {
 }
 
@@ -57,6 +58,16 @@ Thread::Type Thread::type() const
     return d->m_type;
 }
 
+void Thread::setPooled(bool pooled)
+{
+    d->m_pooled = pooled;
+}
+
+bool Thread::isPooled() const
+{
+    return d->m_pooled;
+}
+
 void Thread::run()
 {
     started.emit();
@@ -82,6 +82,9 @@ public:
 
     /**
       * Creates the new thread and executes run method in a new thread.
+      *
+      * @note If the thread cannot be created, run() is not called: NoJoinable threads are deleted
+      *       right away, and join() returns immediately on Joinable ones.
       */
     void exec();
 
@@ -100,6 +103,25 @@ public:
       */
     Type type() const;
 
+    /**
+      * Sets whether exec() runs this thread on a thread taken from a process-wide pool instead of
+      * creating a new one. Threads of the pool wait for a while for more work after run() returns,
+      * so operations that start short-lived threads often do not pay for creating them each time.
+      *
+      * Pooled threads behave the same otherwise: started is emitted from the thread running
+      * run(), join() waits for run() to return, and NoJoinable threads are deleted afterwards.
+      * The pool keeps up to 64 threads. When all of them are busy, a thread is created just for
+      * this run, as if this thread was not pooled.
+      *
+      * @note This must not be changed while this thread is running. By default it is false.
+      */
+    void setPooled(bool pooled);
+
+    /**
+      * @return Whether exec() runs this thread on a thread of the pool.
+      */
+    bool isPooled() const;
+
     /**
       * Emitted when the new thread has been created.
       *
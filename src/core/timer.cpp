@@ -18,21 +18,25 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <string.h>
+
 #include "timer.h"
 #include "private/timer_p.h"
 
-#include "application.h"
-#include "private/application_p.h"
+#include "private/object_p.h"
+#include "private/event_loop_p.h"
 
 namespace IdealCore {
 
 Timer::Private::Private(Timer *q)
     : m_timeoutType(SingleShot)
-    , m_interval(1000)
-    , m_remaining(0)
+    , m_interval(1000000000LL)
+    , m_deadline(0)
+    , m_heapIndex(TimerHeap::NotInHeap)
     , m_state(Stopped)
     , q(q)
 {
+    memset(&m_latenessStats, 0, sizeof(LatenessStats));
 }
 
 Timer::Private::~Private()
@@ -42,20 +46,19 @@ Timer::Private::~Private()
     }
 }
 
-bool Timer::Private::listContains() const
+void Timer::Private::reschedule(iint64 now)
 {
-    Application::Private *const app_d = q->application()->d;
-    if (app_d->m_runningTimerList.empty()) {
-        return false;
+    m_deadline += m_interval;
+    if (m_deadline > now) {
+        return;
     }
-    std::vector<Timer*>::const_iterator it = app_d->m_runningTimerList.begin();
-    while (it != app_d->m_runningTimerList.end()) {
-        if (*it == q) {
-            return true;
-        }
-        ++it;
+    if (!m_interval) {
+        m_deadline = now;
+        return;
     }
-    return false;
+    const iint64 missed = (now - m_deadline) / m_interval + 1;
+    m_deadline += missed * m_interval;
+    m_latenessStats.missedTimeouts += missed;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -80,38 +83,29 @@ Timer::~Timer()
 
 void Timer::start(TimeoutType timeoutType)
 {
-    d->m_timeoutType = timeoutType;
-    d->m_remaining = d->m_interval;
-    d->m_state = Running;
-    Application::Private *const app_d = application()->d;
-    ContextMutexLocker cml(app_d->m_runningTimerListMutex);
-    if (!d->listContains()) {
-        std::vector<Timer*>::iterator it;
-        for (it = app_d->m_runningTimerList.begin(); it != app_d->m_runningTimerList.end(); ++it) {
-            Timer *currTimer = *it;
-            if (currTimer->d->m_remaining < d->m_interval) {
-                continue;
-            }
-            app_d->m_runningTimerList.insert(it, this);
-            return;
-        }
-        app_d->m_runningTimerList.push_back(this);
+    EventLoop *const eventLoop = Object::d->m_eventLoop;
+    bool isNextTimer;
+    {
+        ContextMutexLocker cml(eventLoop->m_runningTimersMutex);
+        d->m_timeoutType = timeoutType;
+        d->m_state = Running;
+        d->m_deadline = monotonicTime() + d->m_interval;
+        eventLoop->m_runningTimers.remove(this);
+        eventLoop->m_runningTimers.push(this);
+        isNextTimer = eventLoop->m_runningTimers.top() == this;
+    }
+    // Only when this timer expires before any other the event loop has to rearm its timer
+    if (isNextTimer) {
+        eventLoop->wakeUp();
     }
 }
 
 void Timer::stop()
 {
+    EventLoop *const eventLoop = Object::d->m_eventLoop;
+    ContextMutexLocker cml(eventLoop->m_runningTimersMutex);
     d->m_state = Stopped;
-    Application::Private *const app_d = application()->d;
-    ContextMutexLocker cml(app_d->m_runningTimerListMutex);
-    std::vector<Timer*>::iterator it = app_d->m_runningTimerList.begin();
-    while (it != app_d->m_runningTimerList.end()) {
-        if (*it == this) {
-            app_d->m_runningTimerList.erase(it);
-            break;
-        }
-        ++it;
-    }
+    eventLoop->m_runningTimers.remove(this);
 }
 
 Timer::State Timer::state() const
@@ -121,14 +115,36 @@ Timer::State Timer::state() const
 
 void Timer::setInterval(iint32 msec)
 {
-    d->m_interval = msec;
+    d->m_interval = (iint64) msec * 1000000;
 }
 
 iint32 Timer::interval() const
+{
+    return d->m_interval / 1000000;
+}
+
+void Timer::setIntervalNsec(iint64 nsec)
+{
+    d->m_interval = nsec;
+}
+
+iint64 Timer::intervalNsec() const
 {
     return d->m_interval;
 }
 
+Timer::LatenessStats Timer::latenessStats() const
+{
+    ContextMutexLocker cml(Object::d->m_eventLoop->m_runningTimersMutex);
+    return d->m_latenessStats;
+}
+
+void Timer::resetLatenessStats()
+{
+    ContextMutexLocker cml(Object::d->m_eventLoop->m_runningTimersMutex);
+    memset(&d->m_latenessStats, 0, sizeof(LatenessStats));
+}
+
 void Timer::wait(iint32 ms)
 {
     Timer t;
@@ -37,6 +37,8 @@ class IDEAL_EXPORT Timer
     : public Object
 {
     friend class Application;
+    friend class EventLoop;
+    friend class TimerHeap;
 
 public:
     Timer(Object *parent);
@@ -57,7 +59,7 @@ public:
       *
       * @note if this timer is already started, it will be restarted.
       *
-      * @param timeoutOnce If true, this timer will expire only one time. Otherwise it will
+      * @param timeoutType If SingleShot, this timer will expire only one time. Otherwise it will
       *                    expire continuously every interval() msec until stopped.
       */
     void start(TimeoutType timeoutType = SingleShot);
@@ -72,6 +74,18 @@ public:
       */
     State state() const;
 
+    /**
+      * Lateness statistics of a timer. Lateness is the measured time between the deadline of the
+      * timer and the moment the main loop noticed it had expired, in nanoseconds.
+      */
+    struct LatenessStats {
+        iuint64 timeouts;        ///< Number of timeouts that were posted
+        iuint64 missedTimeouts;  ///< Number of periods skipped because the timer was too late
+        iint64  lastLateness;    ///< Lateness of the last timeout
+        iint64  maxLateness;     ///< Maximum lateness seen
+        iint64  totalLateness;   ///< Sum of the lateness of all timeouts
+    };
+
     /**
       * Sets the interval of timeout of this timer
       */
@@ -82,11 +96,41 @@ public:
       */
     iint32 interval() const;
 
+    /**
+      * Sets the interval of timeout of this timer, in nanoseconds.
+      *
+      * @note Periodic timers are rescheduled from their previous deadline, not from the moment
+      *       they were noticed to expire, so they do not drift.
+      */
+    void setIntervalNsec(iint64 nsec);
+
+    /**
+      * @return the interval of timeout of this timer, in nanoseconds
+      */
+    iint64 intervalNsec() const;
+
+    /**
+      * @return the lateness statistics of this timer since it was created or the statistics were
+      *         last reset
+      */
+    LatenessStats latenessStats() const;
+
+    /**
+      * Resets the lateness statistics of this timer.
+      */
+    void resetLatenessStats();
+
     /**
       * Will pause the current thread for @p ms milliseconds
       */
     static void wait(iint32 ms);
 
+    /**
+      * @return The current value of a monotonic clock, in nanoseconds. Only the difference between
+      *         two values is meaningful.
+      */
+    static iint64 monotonicTime();
+
     /**
       * Calls @p member in @p receiver after @p ms milliseconds
       */
@@ -120,8 +164,13 @@ template <typename Receiver, typename Member>
 void Timer::callAfter(iint32 ms, Receiver *receiver, Member member)
 {
     Timer *timer = new Timer(receiver);
-    timer->timeout.connect(receiver, member);
-    timer->timeout.connect(timer, &Object::deleteLater);
+    // The timer is a child of receiver, so receiver is alive whenever the timer times out
+    timer->timeout.connect(timer, [receiver, member, timer]() {
+        if (!receiver->areSignalsBlocked()) {
+            (receiver->*member)();
+        }
+        timer->deleteLater();
+    });
     timer->setInterval(ms);
     timer->start();
 }
@@ -130,8 +179,10 @@ template <typename Member>
 void Timer::callStaticAfter(iint32 ms, Member member)
 {
     Timer *timer = new Timer;
-    timer->timeout.connectStatic(member);
-    timer->timeout.connect(timer, &Object::deleteLater);
+    timer->timeout.connect(timer, [member, timer]() {
+        member();
+        timer->deleteLater();
+    });
     timer->setInterval(ms);
     timer->start();
 }
@@ -19,6 +19,7 @@
  */
 
 #include "uri.h"
+#include "ref_count.h"
 #include "stack.h"
 
 namespace IdealCore {
@@ -38,6 +39,10 @@ public:
     void ref();
     void deref();
 
+    /**
+      * @return The data shared by all empty uris, which is never deleted.
+      */
+    static Private *sharedEmpty();
     static Private *empty();
 
     String getHex(Char ch) const;
@@ -86,21 +91,19 @@ public:
     size_t        m_parserLevelUp;
     Stack<String> m_pathStack;
 
-    String  m_uri;
-    String  m_scheme;
-    String  m_userInfo;
-    String  m_username;
-    String  m_password;
-    String  m_host;
-    iint32  m_port;
-    String  m_path;
-    String  m_query;
-    String  m_fragment;
-    bool    m_isValid;
-    size_t  m_refs;
-    bool    m_initialized;
-
-    static Private *m_privateEmpty;
+    String    m_uri;
+    String    m_scheme;
+    String    m_userInfo;
+    String    m_username;
+    String    m_password;
+    String    m_host;
+    iint32    m_port;
+    String    m_path;
+    String    m_query;
+    String    m_fragment;
+    bool      m_isValid;
+    RefCount  m_refs;
+    bool      m_initialized;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -202,21 +205,17 @@ Uri::Private *Uri::Private::copy() const
 
 void Uri::Private::copyAndDetach(Uri *uri)
 {
-    if (m_refs > 1) {
+    if (m_refs.isShared()) {
         uri->d = copy();
         deref();
-    } else if (this == m_privateEmpty) {
-        m_privateEmpty = 0;
     }
 }
 
 void Uri::Private::newAndDetach(Uri *uri)
 {
-    if (m_refs > 1) {
+    if (m_refs.isShared()) {
         uri->d = new Private;
         deref();
-    } else if (this == m_privateEmpty) {
-        m_privateEmpty = 0;
     } else {
         clearContents();
     }
@@ -250,28 +249,27 @@ void Uri::Private::clearContents()
 
 void Uri::Private::ref()
 {
-    ++m_refs;
+    m_refs.ref();
 }
 
 void Uri::Private::deref()
 {
-    --m_refs;
-    if (!m_refs) {
-        if (this == m_privateEmpty) {
-            m_privateEmpty = 0;
-        }
+    if (m_refs.deref()) {
         delete this;
     }
 }
 
+Uri::Private *Uri::Private::sharedEmpty()
+{
+    static Private *const privateEmpty = new Private;
+    return privateEmpty;
+}
+
 Uri::Private *Uri::Private::empty()
 {
-    if (!m_privateEmpty) {
-        m_privateEmpty = new Private;
-    } else {
-        m_privateEmpty->ref();
-    }
-    return m_privateEmpty;
+    Private *const res = sharedEmpty();
+    res->ref();
+    return res;
 }
 
 String Uri::Private::getHex(Char ch) const
@@ -1351,8 +1349,6 @@ bool Uri::Private::parseReserved()
     return false;
 }
 
-Uri::Private *Uri::Private::m_privateEmpty = 0;
-
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 Uri::Uri()
@@ -1506,7 +1502,7 @@ Uri &Uri::dirUp()
     if (!d->m_initialized) {
         d->initializeContents();
     }
-    if (d == Private::m_privateEmpty || d->m_path.empty()) {
+    if (d == Private::sharedEmpty() || d->m_path.empty()) {
         return *this;
     }
     d->copyAndDetach(this);
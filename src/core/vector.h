@@ -22,6 +22,7 @@
 #define IDEAL_VECTOR_H
 
 #include <ideal_export.h>
+#include <core/ref_count.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -353,6 +354,10 @@ public:
     void ref();
     void deref();
 
+    /**
+      * @return The data shared by all empty vectors, which is never deleted.
+      */
+    static Private *sharedEmpty();
     static Private *empty();
 
     struct Element {
@@ -363,9 +368,8 @@ public:
     size_t    m_size;
     size_t    m_containerSize;
     size_t    m_count;
-    size_t    m_refs;
+    RefCount  m_refs;
 
-    static Private     *m_privateEmpty;
     static T            m_emptyRes;
     static const size_t m_initialContainerSize;
 };
@@ -409,22 +413,18 @@ typename Vector<T>::Private *Vector<T>::Private::copy() const
 template <typename T>
 void Vector<T>::Private::copyAndDetach(Vector<T> *vector)
 {
-    if (m_refs > 1) {
+    if (m_refs.isShared()) {
         vector->d = copy();
         deref();
-    } else if (this == m_privateEmpty) {
-        m_privateEmpty = 0;
     }
 }
 
 template <typename T>
 void Vector<T>::Private::newAndDetach(Vector<T> *vector)
 {
-    if (m_refs > 1) {
+    if (m_refs.isShared()) {
         vector->d = new Private;
         deref();
-    } else if (this == m_privateEmpty) {
-        m_privateEmpty = 0;
     } else {
         clearContents();
     }
@@ -443,34 +443,31 @@ void Vector<T>::Private::clearContents()
 template <typename T>
 void Vector<T>::Private::ref()
 {
-    ++m_refs;
+    m_refs.ref();
 }
 
 template <typename T>
 void Vector<T>::Private::deref()
 {
-    --m_refs;
-    if (!m_refs) {
-        if (this == m_privateEmpty) {
-            m_privateEmpty = 0;
-        }
+    if (m_refs.deref()) {
         delete this;
     }
 }
 
 template <typename T>
-typename Vector<T>::Private *Vector<T>::Private::empty()
+typename Vector<T>::Private *Vector<T>::Private::sharedEmpty()
 {
-    if (!m_privateEmpty) {
-        m_privateEmpty = new Private;
-    } else {
-        m_privateEmpty->ref();
-    }
-    return m_privateEmpty;
+    static Private *const privateEmpty = new Private;
+    return privateEmpty;
 }
 
 template <typename T>
-typename Vector<T>::Private *Vector<T>::Private::m_privateEmpty = 0;
+typename Vector<T>::Private *Vector<T>::Private::empty()
+{
+    Private *const res = sharedEmpty();
+    res->ref();
+    return res;
+}
 
 template <typename T>
 T Vector<T>::Private::m_emptyRes = T();
@@ -605,7 +602,7 @@ void Vector<T>::removeAt(size_t i)
 template <typename T>
 void Vector<T>::clear()
 {
-    if (d == Private::m_privateEmpty) {
+    if (d == Private::sharedEmpty()) {
         return;
     }
     d->deref();
@@ -0,0 +1,58 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "worker_thread.h"
+#include "private/worker_thread_p.h"
+#include "private/object_p.h"
+
+namespace IdealCore {
+
+WorkerThread::WorkerThread(Object *parent)
+    : Thread(parent, Joinable)
+    , d(new Private)
+{
+    Object::d->m_childrenEventLoop = &d->m_eventLoop;
+}
+
+WorkerThread::~WorkerThread()
+{
+    // Children belong to our event loop, so they have to go away before it does
+    if (isDeleteChildrenRecursively()) {
+        List<Object*> childrenToDelete = children();
+        List<Object*>::iterator it;
+        for (it = childrenToDelete.begin(); it != childrenToDelete.end(); ++it) {
+            delete *it;
+        }
+    }
+    delete d;
+}
+
+void WorkerThread::quit()
+{
+    d->m_eventLoop.quit();
+}
+
+void WorkerThread::run()
+{
+    started.emit();
+    d->m_eventLoop.exec();
+}
+
+}
@@ -0,0 +1,79 @@
+/*
+ * This file is part of the Ideal Library
+ * Copyright (C) 2009 Rafael Fernández López <ereslibre@ereslibre.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef WORKER_THREAD_H
+#define WORKER_THREAD_H
+
+#include <ideal_export.h>
+#include <core/thread.h>
+
+namespace IdealCore {
+
+/**
+  * @class WorkerThread worker_thread.h core/worker_thread.h
+  *
+  * A thread that runs its own event loop. Objects created with a WorkerThread as their parent,
+  * and all their descendants, belong to the loop of the worker instead of to the main loop of the
+  * application: their timers expire, their queued slots are called and their deleteLater() takes
+  * effect in the worker thread. The WorkerThread object itself belongs to the loop of its parent.
+  *
+  * @code
+  * WorkerThread *worker = new WorkerThread(&app);
+  * Connection *connection = new Connection(worker); // lives in the worker thread
+  * socket->dataReceived.connectQueued(connection, &Connection::processData);
+  * worker->exec();
+  * ...
+  * worker->quit();
+  * worker->join();
+  * delete worker;
+  * @endcode
+  *
+  * @note The event loop only runs between exec() and quit(). The worker has to be quit and joined
+  *       before it is deleted. Its children are deleted before its event loop is.
+  *
+  * @author Rafael Fernández López <ereslibre@ereslibre.es>
+  */
+class IDEAL_EXPORT WorkerThread
+    : public Thread
+{
+public:
+    WorkerThread(Object *parent);
+    virtual ~WorkerThread();
+
+    /**
+      * Makes the event loop of this worker return, so the thread finishes. It can be called from
+      * any thread.
+      */
+    void quit();
+
+protected:
+    /**
+      * Emits started from the new thread and then runs the event loop until quit() is called.
+      */
+    virtual void run();
+
+private:
+    class Private;
+    Private *const d;
+};
+
+}
+
+#endif //WORKER_THREAD_H
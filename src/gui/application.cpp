@@ -30,6 +30,7 @@ namespace IdealGUI {
 
 Application::Private::Private(Application *q)
     : m_guiEventHandler(0)
+    , m_guiEventDispatcher(new GUIEventDispatcher)
     , q(q)
 {
 }
@@ -37,6 +38,7 @@ Application::Private::Private(Application *q)
 Application::Private::~Private()
 {
     delete m_guiEventHandler;
+    delete m_guiEventDispatcher;
 }
 
 Application::Private::GUIEventHandler::GUIEventHandler(Object *parent, Application::Private *priv)
@@ -56,18 +58,13 @@ void Application::Private::GUIEventHandler::run()
     }
 }
 
-Application::Private::GUIEventDispatcher::GUIEventDispatcher(Object *parent)
-    : EventDispatcher(parent)
+void Application::Private::GUIEventDispatcher::dispatchEvent(IdealCore::Event *event)
 {
-}
-
-void Application::Private::GUIEventDispatcher::run()
-{
-    if (!m_event || !m_event->object()) {
+    if (!event->object()) {
         return;
     }
-    Widget *const widget = static_cast<Widget*>(m_event->object());
-    switch (m_event->type()) {
+    Widget *const widget = static_cast<Widget*>(event->object());
+    switch (event->type()) {
         case IdealCore::Event::CreateNotify:
         case IdealCore::Event::MapNotify:
         case IdealCore::Event::UnmapNotify:
@@ -82,10 +79,10 @@ void Application::Private::GUIEventDispatcher::run()
         case IdealCore::Event::Expose:
         case IdealCore::Event::FocusIn:
         case IdealCore::Event::FocusOut:
-            widget->event(m_event);
+            widget->event(event);
             break;
         default:
-            IDEAL_DEBUG_WARNING("Unexpected event type " << m_event->type());
+            IDEAL_DEBUG_WARNING("Unexpected event type " << event->type());
             break;
     }
 }
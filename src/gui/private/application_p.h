@@ -42,6 +42,7 @@ public:
     GUIEventHandler *m_guiEventHandler;
 
     class GUIEventDispatcher;
+    GUIEventDispatcher *m_guiEventDispatcher;
 
     Application     *q;
 };
@@ -64,10 +65,7 @@ class Application::Private::GUIEventDispatcher
     : public IdealCore::EventDispatcher
 {
 public:
-    GUIEventDispatcher(Object *parent);
-
-protected:
-    virtual void run();
+    virtual void dispatchEvent(IdealCore::Event *event);
 };
 
 }
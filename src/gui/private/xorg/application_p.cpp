@@ -94,9 +94,7 @@ void Application::Private::processEvents()
             IDEAL_DEBUG("unknown event received: " << xe.type);
             return;
     }
-    GUIEventDispatcher *guiEventDispatcher = new GUIEventDispatcher(q);
-    guiEventDispatcher->postEvent(event);
-    guiEventDispatcher->exec();
+    q->postEvent(event, d->m_guiEventDispatcher);
 }
 
 }